@@ -0,0 +1,150 @@
+// Bvh queries against a brute force scan over the same boxes.
+//   g++ -O2 -mavx -pthread -I. Core/ThreadPool.cpp Scene/Bvh.cpp Benchmarks/BvhBench.cpp -o BvhBench
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Core/ThreadPool.hpp"
+#include "Scene/Bvh.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+template<typename F>
+static double timeUs(F&& f, int iterations) {
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) f(i);
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+}
+
+static bool bruteRay(const std::vector<AABB>& boxes, const Vec3& o, const Vec3& d, float& bestT) {
+    bool found = false;
+    bestT = FLT_MAX;
+    for (const AABB& b : boxes) {
+        float t0 = 0.0f, t1 = FLT_MAX;
+        const float o3[3] = { o.x, o.y, o.z }, d3[3] = { d.x, d.y, d.z };
+        const float lo[3] = { b.min.x, b.min.y, b.min.z }, hi[3] = { b.max.x, b.max.y, b.max.z };
+        bool hit = true;
+        for (int a = 0; a < 3 && hit; a++) {
+            float ta = (lo[a] - o3[a]) / d3[a], tb = (hi[a] - o3[a]) / d3[a];
+            t0 = std::max(t0, std::min(ta, tb));
+            t1 = std::min(t1, std::max(ta, tb));
+            hit = t0 <= t1;
+        }
+        if (hit && t0 < bestT) {
+            bestT = t0;
+            found = true;
+        }
+    }
+    return found;
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const int queries = 200;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(-500.0f, 500.0f), size(0.5f, 3.0f), unit(-1.0f, 1.0f);
+
+    std::vector<AABB> boxes(count);
+    for (AABB& b : boxes) {
+        Vec3 p(pos(rng), pos(rng), pos(rng));
+        b.expand(p);
+        b.expand(p + Vec3(size(rng), size(rng), size(rng)));
+    }
+
+    ThreadPool pool;
+    Bvh bvh(&pool);
+    for (const AABB& b : boxes) bvh.insert(b);
+
+    auto start = Clock::now();
+    bvh.build();
+    double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << count << " objects, SAH build " << buildMs << " ms, " << bvh.stats().nodes << " nodes\n";
+
+    std::vector<Frustum> frusta;
+    std::vector<AABB> regions;
+    std::vector<Vec3> rayOrigins, rayDirs;
+    for (int i = 0; i < queries; i++) {
+        Vec3 eye(pos(rng), pos(rng), pos(rng));
+        Vec3 dir = normalize(Vec3(unit(rng), unit(rng), unit(rng)));
+        frusta.push_back(Frustum::fromMatrix(Mat4::perspective(1.0f, 1.5f, 0.1f, 150.0f) * Mat4::lookAt(eye, eye + dir, { 0, 1, 0 })));
+        AABB r;
+        r.expand(eye);
+        r.expand(eye + Vec3(40, 40, 40));
+        regions.push_back(r);
+        rayOrigins.push_back(eye);
+        rayDirs.push_back(dir);
+    }
+
+    std::vector<uint32_t> out, brute;
+    bool ok = true;
+
+    double bvhFrustum = timeUs([&](int i) { bvh.queryFrustum(frusta[i], out); }, queries);
+    double bruteFrustum = timeUs([&](int i) {
+        brute.clear();
+        for (uint32_t id = 0; id < count; id++) if (frusta[i].intersects(boxes[id])) brute.push_back(id);
+    }, queries);
+
+    double bvhOverlap = timeUs([&](int i) { bvh.queryOverlap(regions[i], out); }, queries);
+    double bruteOverlap = timeUs([&](int i) {
+        brute.clear();
+        for (uint32_t id = 0; id < count; id++) if (boxes[id].overlaps(regions[i])) brute.push_back(id);
+    }, queries);
+
+    RayHit hit;
+    float bruteT = 0.0f;
+    double bvhRay = timeUs([&](int i) { bvh.raycast(rayOrigins[i], rayDirs[i], FLT_MAX, hit); }, queries);
+    double bruteRayUs = timeUs([&](int i) { bruteRay(boxes, rayOrigins[i], rayDirs[i], bruteT); }, queries);
+
+    // results must match the scan
+    for (int i = 0; i < queries && ok; i++) {
+        bvh.queryFrustum(frusta[i], out);
+        brute.clear();
+        for (uint32_t id = 0; id < count; id++) if (frusta[i].intersects(boxes[id])) brute.push_back(id);
+        std::sort(out.begin(), out.end());
+        ok = out == brute;
+
+        bool bvhHit = bvh.raycast(rayOrigins[i], rayDirs[i], FLT_MAX, hit);
+        bool bruteHit = bruteRay(boxes, rayOrigins[i], rayDirs[i], bruteT);
+        ok = ok && bvhHit == bruteHit && (!bvhHit || std::abs(hit.t - bruteT) < 1e-3f);
+    }
+
+    std::cout << "query          bvh (us)   brute force (us)\n";
+    std::cout << "frustum        " << bvhFrustum << "   " << bruteFrustum << "\n";
+    std::cout << "aabb overlap   " << bvhOverlap << "   " << bruteOverlap << "\n";
+    std::cout << "ray cast       " << bvhRay << "   " << bruteRayUs << "\n";
+
+    // move 10% of the objects every frame until a background rebuild kicks in
+    double updateMs = 0.0;
+    int frames = 0;
+    size_t rebuildsBefore = bvh.stats().rebuilds;
+    for (; frames < 200 && bvh.stats().rebuilds == rebuildsBefore; frames++) {
+        for (size_t n = 0; n < count / 10; n++) {
+            uint32_t id = rng() % count;
+            Vec3 d(unit(rng) * 5.0f, unit(rng) * 5.0f, unit(rng) * 5.0f);
+            boxes[id].min = boxes[id].min + d;
+            boxes[id].max = boxes[id].max + d;
+            bvh.move(id, boxes[id]);
+        }
+        auto t = Clock::now();
+        bvh.update();
+        updateMs += std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+    }
+    std::cout << "refit: " << updateMs / frames << " ms/frame over " << frames << " frames, "
+              << bvh.stats().rebuilds - rebuildsBefore << " background rebuild(s)\n";
+
+    for (int i = 0; i < queries && ok; i++) {
+        bvh.queryOverlap(regions[i], out);
+        brute.clear();
+        for (uint32_t id = 0; id < count; id++) if (boxes[id].overlaps(regions[i])) brute.push_back(id);
+        std::sort(out.begin(), out.end());
+        ok = out == brute;
+    }
+
+    std::cout << (ok ? "results match brute force\n" : "RESULT MISMATCH\n");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
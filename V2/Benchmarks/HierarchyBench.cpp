@@ -0,0 +1,83 @@
+// TransformHierarchy::update() cost for a large tree with 1% and 100% of the nodes touched.
+//   g++ -O2 -mavx -pthread -I. Math/TransformBatch.cpp Core/ThreadPool.cpp
+//       Scene/TransformHierarchy.cpp Benchmarks/HierarchyBench.cpp -o HierarchyBench
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Core/ThreadPool.hpp"
+#include "Scene/TransformHierarchy.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double updateMs(TransformHierarchy& h, double dirtyFraction, std::mt19937& rng, int iterations, size_t& touched) {
+    std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(h.size() - 1));
+    size_t dirtyCount = static_cast<size_t>(h.size() * dirtyFraction);
+    double total = 0.0;
+    touched = 0;
+
+    for (int it = 0; it < iterations; it++) {
+        float angle = 0.001f * it;
+        if (dirtyFraction >= 1.0) {
+            for (uint32_t n = 0; n < h.size(); n++) {
+                h.setRotation(n, Quat::fromAxisAngle({ 0, 0, 1 }, angle));
+            }
+        } else {
+            for (size_t n = 0; n < dirtyCount; n++) {
+                h.setRotation(pick(rng), Quat::fromAxisAngle({ 0, 0, 1 }, angle));
+            }
+        }
+
+        auto start = Clock::now();
+        h.update();
+        total += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        touched += h.lastUpdateCount();
+    }
+    touched /= iterations;
+    return total / iterations;
+}
+
+int main(int argc, char** argv) {
+    uint32_t nodeCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 50;
+    const uint32_t roots = 64;
+
+    std::mt19937 rng(42);
+    ThreadPool pool;
+    TransformHierarchy single;
+    TransformHierarchy parallel(&pool);
+
+    // a forest of 4-ary trees, roughly 8 levels deep
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        uint32_t parent = i < roots ? TransformHierarchy::kNoParent : (i - roots) / 4;
+        Vec3 t(0.1f * (i % 7), 0.2f, 0.0f);
+        single.create(parent, t);
+        parallel.create(parent, t);
+    }
+    single.update();
+    parallel.update();
+
+    std::cout << nodeCount << " nodes, " << pool.concurrency() << " threads\n";
+    for (double fraction : { 0.01, 1.0 }) {
+        size_t touched1 = 0, touchedN = 0;
+        double ms1 = updateMs(single, fraction, rng, iterations, touched1);
+        double msN = updateMs(parallel, fraction, rng, iterations, touchedN);
+        std::cout << fraction * 100 << "% set dirty (" << touched1 << " nodes recomputed incl. children)\n";
+        std::cout << "  1 thread:  " << ms1 << " ms\n";
+        std::cout << "  " << pool.concurrency() << " threads: " << msN << " ms\n";
+    }
+
+    // both must agree
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        for (int j = 0; j < 16; j++) {
+            if (std::abs(single.world(i).m[j] - parallel.world(i).m[j]) > 1e-4f) {
+                std::cerr << "mismatch at node " << i << "\n";
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
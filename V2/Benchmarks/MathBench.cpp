@@ -0,0 +1,62 @@
+// Matrices per second for the TRS batch kernels, scalar vs SIMD.
+// Needs no window or GL context:
+//   g++ -O2 -mavx -I. Math/TransformBatch.cpp Benchmarks/MathBench.cpp -o MathBench
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Math/Math.hpp"
+#include "Math/TransformBatch.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+template<typename F>
+static double matricesPerSecond(F&& kernel, size_t count, int iterations) {
+    kernel(); // warm up caches
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        kernel();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return double(count) * iterations / seconds;
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    TransformSoA transforms;
+    transforms.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        Quat q = normalize(Quat(dist(rng), dist(rng), dist(rng), dist(rng)));
+        transforms.set(i, { dist(rng), dist(rng), dist(rng) }, q, { 1.0f, 1.0f, 1.0f });
+    }
+
+    std::vector<Mat4> scalarOut(count), simdOut(count);
+
+    double scalar = matricesPerSecond([&] { composeTRSScalar(transforms, 0, count, scalarOut.data()); }, count, iterations);
+    double simd = matricesPerSecond([&] { composeTRSSimd(transforms, 0, count, simdOut.data()); }, count, iterations);
+
+    // make sure both paths agree before trusting the numbers
+    float maxError = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        for (int j = 0; j < 16; j++) {
+            maxError = std::max(maxError, std::abs(scalarOut[i].m[j] - simdOut[i].m[j]));
+        }
+    }
+
+    std::cout << "TRS -> mat4, " << count << " transforms x " << iterations << " iterations\n";
+    std::cout << "scalar:         " << scalar / 1e6 << " M matrices/s\n";
+    std::cout << "simd (" << simdPathName() << "): " << simd / 1e6 << " M matrices/s\n";
+    std::cout << "speedup:        " << simd / scalar << "x\n";
+    std::cout << "max abs error:  " << maxError << "\n";
+
+    return maxError < 1e-5f ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,297 @@
+// Renderer microbenchmarks: buffer uploads, texture decode + upload, shader compile + link,
+// Mesh::draw submission and uniform updates. Every case runs a warm-up, then `reps` timed
+// samples, and all raw samples go into the JSON so runs can be compared statistically.
+// Built by the RendererBench target in V2/CMakeLists.txt:
+//   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release && cmake --build build --target RendererBench
+//   RendererBench [--headless] [--reps n] [--json results.json]
+// Run from V2/ (it writes its test images and shaders to bench_tmp/). llvmpipe works:
+//   LIBGL_ALWAYS_SOFTWARE=1 ./build/RendererBench --headless --json bench.json
+#define SDL_MAIN_HANDLED
+#include <SDL_2/SDL.h>
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "stb_image.h"
+
+#include "Window/Window.hpp"
+#include "Shader/Shader.hpp"
+#include "Mesh/Mesh.hpp"
+#include "Renderer/Texture.hpp"
+#include "Renderer/VertexBuffer.hpp"
+#include "Debug/Profiler.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    std::string name;
+    std::string param;
+    std::string unit;     // of the samples
+    std::vector<double> samples;
+};
+
+static std::vector<Result> results;
+
+static double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 0 rather than inf/nan when the timer didn't tick, neither is valid JSON
+static double perSecond(double amount, double ms) {
+    return ms > 0.0 ? amount / (ms / 1000.0) : 0.0;
+}
+
+// warm-up run, then reps samples of whatever fn returns
+static Result& run(const std::string& name, const std::string& param, const std::string& unit,
+                   int reps, const std::function<double()>& fn) {
+    fn();
+    Result r{ name, param, unit, {} };
+    for (int i = 0; i < reps; i++) {
+        r.samples.push_back(fn());
+    }
+    results.push_back(std::move(r));
+    return results.back();
+}
+
+struct Summary {
+    double mean = 0, median = 0, stddev = 0, min = 0, max = 0;
+};
+
+static Summary summarize(std::vector<double> v) {
+    Summary s;
+    if (v.empty()) return s;
+    std::sort(v.begin(), v.end());
+    for (double x : v) s.mean += x;
+    s.mean /= v.size();
+    for (double x : v) s.stddev += (x - s.mean) * (x - s.mean);
+    s.stddev = v.size() > 1 ? std::sqrt(s.stddev / (v.size() - 1)) : 0.0;
+    s.median = v[v.size() / 2];
+    s.min = v.front();
+    s.max = v.back();
+    return s;
+}
+
+static void print(const Result& r) {
+    Summary s = summarize(r.samples);
+    std::printf("%-22s %-14s median %12.3f  mean %12.3f  sd %10.3f  %s\n",
+                r.name.c_str(), r.param.c_str(), s.median, s.mean, s.stddev, r.unit.c_str());
+}
+
+// Uncompressed 32 bit TGA, stb_image reads it and it needs no encoder
+static void writeTga(const std::string& path, int size) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * 4);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            uint8_t* p = &pixels[(static_cast<size_t>(y) * size + x) * 4];
+            p[0] = static_cast<uint8_t>(x); p[1] = static_cast<uint8_t>(y);
+            p[2] = static_cast<uint8_t>(x ^ y); p[3] = 255;
+        }
+    }
+    uint8_t header[18] = {};
+    header[2] = 2; // uncompressed true color
+    header[12] = size & 0xff; header[13] = (size >> 8) & 0xff;
+    header[14] = size & 0xff; header[15] = (size >> 8) & 0xff;
+    header[16] = 32;
+    header[17] = 8; // alpha bits
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+}
+
+static void writeFile(const std::string& path, const std::string& text) {
+    std::ofstream out(path);
+    out << text;
+}
+
+static void benchBufferUpload(int reps) {
+    for (size_t size : { size_t(4) << 10, size_t(64) << 10, size_t(1) << 20, size_t(16) << 20, size_t(64) << 20 }) {
+        std::vector<uint8_t> data(size, 0x5a);
+        Result& r = run("VertexBuffer upload", std::to_string(size >> 10) + " KiB", "MiB/s", reps, [&] {
+            Clock::time_point start = Clock::now();
+            VertexBuffer vbo(data.data(), size);
+            glFinish(); // the copy may be deferred until the driver needs it
+            double ms = elapsedMs(start);
+            return perSecond(size / (1024.0 * 1024.0), ms);
+        });
+        print(r);
+    }
+}
+
+static void benchTexture(int reps) {
+    for (int size : { 256, 512, 1024, 2048, 4096 }) {
+        std::string path = "bench_tmp/tex" + std::to_string(size) + ".tga";
+        writeTga(path, size);
+        std::string param = std::to_string(size) + "x" + std::to_string(size);
+
+        Result& decode = run("Texture decode", param, "ms", reps, [&] {
+            Clock::time_point start = Clock::now();
+            int w, h, c;
+            unsigned char* pixels = stbi_load(path.c_str(), &w, &h, &c, 4);
+            double ms = elapsedMs(start);
+            stbi_image_free(pixels);
+            return ms;
+        });
+        print(decode);
+
+        // decode + upload + mipmaps, the way the app loads textures
+        Result& full = run("Texture load", param, "ms", reps, [&] {
+            Clock::time_point start = Clock::now();
+            Texture tex(path);
+            glFinish();
+            return elapsedMs(start);
+        });
+        print(full);
+    }
+}
+
+static void benchShaderCompile(int reps) {
+    std::ifstream vIn("Shaders/vertex_shader.glsl"), fIn("Shaders/fragment_shader.glsl");
+    std::string vSrc((std::istreambuf_iterator<char>(vIn)), std::istreambuf_iterator<char>());
+    std::string fSrc((std::istreambuf_iterator<char>(fIn)), std::istreambuf_iterator<char>());
+
+    int variant = 0;
+    Result& r = run("Shader compile+link", "scene shader", "ms", reps, [&] {
+        // a unique comment each time, otherwise the driver's shader cache answers
+        std::string tag = "\n// variant " + std::to_string(variant++) + "\n";
+        writeFile("bench_tmp/bench.vert", vSrc + tag);
+        writeFile("bench_tmp/bench.frag", fSrc + tag);
+
+        Clock::time_point start = Clock::now();
+        Shader shader("bench_tmp/bench.vert", "bench_tmp/bench.frag");
+        shader.use(); // forces the link to finish on drivers that defer it
+        glFinish();
+        return elapsedMs(start);
+    });
+    print(r);
+}
+
+static void benchDraws(int reps, const Shader& shader, const Mesh& mesh) {
+    shader.use();
+    float identity[16] = { 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1 };
+    shader.setMat4("uModel", identity);
+
+    for (int batch : { 100, 1000, 10000 }) {
+        Result& submit = run("Mesh::draw submit", std::to_string(batch) + " draws", "draws/s", reps, [&] {
+            glFinish();
+            Clock::time_point start = Clock::now();
+            for (int i = 0; i < batch; i++) mesh.draw();
+            double ms = elapsedMs(start);
+            glFinish();
+            return perSecond(batch, ms);
+        });
+        print(submit);
+
+        Result& complete = run("Mesh::draw complete", std::to_string(batch) + " draws", "draws/s", reps, [&] {
+            glFinish();
+            Clock::time_point start = Clock::now();
+            for (int i = 0; i < batch; i++) mesh.draw();
+            glFinish();
+            return perSecond(batch, elapsedMs(start));
+        });
+        print(complete);
+    }
+}
+
+static void benchUniforms(int reps, const Shader& shader) {
+    shader.use();
+    float m[16] = { 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1 };
+    const int count = 100000;
+
+    Result& mat = run("Uniform setMat4", std::to_string(count) + " updates", "updates/s", reps, [&] {
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < count; i++) {
+            m[12] = static_cast<float>(i & 7) * 0.01f;
+            shader.setMat4("uModel", m);
+        }
+        return perSecond(count, elapsedMs(start));
+    });
+    print(mat);
+
+    Result& i1 = run("Uniform setInt", std::to_string(count) + " updates", "updates/s", reps, [&] {
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < count; i++) shader.setInt("uTexture", i & 1);
+        return perSecond(count, elapsedMs(start));
+    });
+    print(i1);
+}
+
+static bool writeJson(const char* path) {
+    FILE* out = std::fopen(path, "w");
+    if (!out) return false;
+
+    std::fprintf(out, "{\n  \"renderer\": \"%s\",\n  \"version\": \"%s\",\n  \"results\": [",
+                 reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+                 reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        Summary s = summarize(r.samples);
+        std::fprintf(out, "%s\n    {\"name\": \"%s\", \"param\": \"%s\", \"unit\": \"%s\", "
+                          "\"mean\": %.6f, \"median\": %.6f, \"stddev\": %.6f, \"min\": %.6f, \"max\": %.6f, \"samples\": [",
+                     i ? "," : "", r.name.c_str(), r.param.c_str(), r.unit.c_str(),
+                     s.mean, s.median, s.stddev, s.min, s.max);
+        for (size_t j = 0; j < r.samples.size(); j++) {
+            std::fprintf(out, "%s%.6f", j ? ", " : "", r.samples[j]);
+        }
+        std::fprintf(out, "]}");
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+    std::fclose(out);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool headless = false;
+    int reps = 10;
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--headless")) headless = true;
+        else if (!std::strcmp(argv[i], "--reps") && i + 1 < argc) reps = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--json") && i + 1 < argc) jsonPath = argv[++i];
+    }
+
+    WindowSettings settings;
+    settings.headless = headless;
+    settings.swapInterval = SwapInterval::Immediate;
+    Window window(256, 256, "RendererBench", settings);
+
+    // measure the wrappers, not the instrumentation
+    Profiler::get().enabled = false;
+
+    std::filesystem::create_directories("bench_tmp");
+
+    Shader shader("Shaders/vertex_shader.glsl", "Shaders/fragment_shader.glsl");
+    float vertices[] = {
+         0.0f,  0.5f,   1.0f, 0.0f, 0.0f, 0.5f, 1.0f,
+        -0.5f, -0.5f,   0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+         0.5f, -0.5f,   0.0f, 0.0f, 1.0f, 1.0f, 0.0f
+    };
+    VertexLayout layout;
+    layout.push<float>(2);
+    layout.push<float>(3);
+    layout.push<float>(2);
+    Mesh triangle(vertices, 21, layout);
+
+    std::printf("renderer: %s\n", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+
+    benchBufferUpload(reps);
+    benchTexture(reps);
+    benchShaderCompile(reps);
+    benchDraws(reps, shader, triangle);
+    benchUniforms(reps, shader);
+
+    if (jsonPath && !writeJson(jsonPath)) {
+        std::cerr << "Could not write " << jsonPath << "\n";
+        return 1;
+    }
+    return 0;
+}
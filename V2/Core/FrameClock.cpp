@@ -0,0 +1,132 @@
+#include "FrameClock.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+FrameTimeHistogram::FrameTimeHistogram(size_t window, double maxMs)
+    : samples(std::max<size_t>(window, 1), 0.0),
+    buckets(static_cast<size_t>(std::ceil(maxMs / kBucketMs)) + 1, 0)
+{
+}
+
+size_t FrameTimeHistogram::bucketOf(double ms) const {
+    if (!(ms > 0.0)) return 0;
+    size_t b = static_cast<size_t>(ms / kBucketMs);
+    return std::min(b, buckets.size() - 1);
+}
+
+void FrameTimeHistogram::add(double ms) {
+    if (count == samples.size()) {
+        // window is full, the oldest sample falls out
+        double old = samples[next];
+        buckets[bucketOf(old)]--;
+        sum -= old;
+    } else {
+        count++;
+    }
+    samples[next] = ms;
+    buckets[bucketOf(ms)]++;
+    sum += ms;
+    next = (next + 1) % samples.size();
+}
+
+void FrameTimeHistogram::clear() {
+    std::fill(buckets.begin(), buckets.end(), 0);
+    next = 0;
+    count = 0;
+    sum = 0.0;
+}
+
+double FrameTimeHistogram::percentile(double p) const {
+    if (count == 0) return 0.0;
+
+    size_t rank = static_cast<size_t>(std::ceil(std::clamp(p, 0.0, 1.0) * count));
+    rank = std::max<size_t>(rank, 1);
+
+    size_t seen = 0;
+    for (size_t b = 0; b < buckets.size(); b++) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            return (b + 1) * kBucketMs;
+        }
+    }
+    return buckets.size() * kBucketMs;
+}
+
+double FrameTimeHistogram::maxSeen() const {
+    double m = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        m = std::max(m, samples[i]);
+    }
+    return m;
+}
+
+void FrameTimeHistogram::print(std::ostream& out, const char* label) const {
+    out << label << ": avg " << average() << " ms, p50 " << percentile(0.50)
+        << " p95 " << percentile(0.95) << " p99 " << percentile(0.99)
+        << " max " << maxSeen() << " ms (" << count << " frames)\n";
+}
+
+FrameClock::FrameClock(double fixedStepSeconds, int maxStepsPerFrame)
+    : fixedStepSeconds(fixedStepSeconds), maxStepsPerFrame(maxStepsPerFrame)
+{
+}
+
+void FrameClock::beginFrame() {
+    frameStart = Clock::now();
+    if (!started) {
+        // first frame simulates exactly one step
+        lastFrameStart = frameStart;
+        frameDelta = fixedStepSeconds;
+        started = true;
+    } else {
+        frameDelta = std::chrono::duration<double>(frameStart - lastFrameStart).count();
+        lastFrameStart = frameStart;
+    }
+
+    accumulator += frameDelta;
+    stepsThisFrame = 0;
+    frames++;
+}
+
+void FrameClock::resync() {
+    started = false;
+    presented = false;
+    accumulator = 0.0;
+}
+
+bool FrameClock::step() {
+    if (accumulator < fixedStepSeconds) {
+        return false;
+    }
+    if (stepsThisFrame == maxStepsPerFrame) {
+        // way behind (breakpoint, window drag, ...), drop the rest instead of spiralling
+        dropped += static_cast<uint64_t>(accumulator / fixedStepSeconds);
+        accumulator = std::fmod(accumulator, fixedStepSeconds);
+        return false;
+    }
+    accumulator -= fixedStepSeconds;
+    simulatedTime += fixedStepSeconds;
+    stepsThisFrame++;
+    return true;
+}
+
+void FrameClock::endCpuWork() {
+    cpuTimes.add(millis(Clock::now() - frameStart));
+}
+
+void FrameClock::markPresent(Clock::time_point when) {
+    if (presented) {
+        presentTimes.add(millis(when - lastPresent));
+    }
+    lastPresent = when;
+    presented = true;
+}
+
+void FrameClock::print(std::ostream& out) const {
+    cpuTimes.print(out, "cpu frame");
+    presentTimes.print(out, "present-to-present");
+    if (dropped) {
+        out << "dropped " << dropped << " simulation steps\n";
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Rolling histogram over the last `window` samples, in milliseconds.
+// Samples land in fixed 0.05 ms buckets (everything above maxMs goes in the last one),
+// so adding a sample and asking for a percentile never sorts anything.
+class FrameTimeHistogram {
+public:
+    explicit FrameTimeHistogram(size_t window = 1024, double maxMs = 100.0);
+
+    void add(double ms);
+    void clear();
+
+    // p in [0, 1], returns the upper edge of the bucket the percentile falls in
+    double percentile(double p) const;
+    double average() const { return count ? sum / count : 0.0; }
+    double maxSeen() const;
+    size_t size() const { return count; }
+
+    void print(std::ostream& out, const char* label) const;
+private:
+    static constexpr double kBucketMs = 0.05;
+
+    size_t bucketOf(double ms) const;
+
+    std::vector<double> samples; // ring buffer
+    std::vector<uint32_t> buckets;
+    size_t next = 0;
+    size_t count = 0;
+    double sum = 0.0;
+};
+
+// Wall clock for the main loop plus a fixed-timestep accumulator.
+//
+//   clock.beginFrame();
+//   while (clock.step()) simulate(clock.fixedStep());
+//   render(lerp(previous, current, clock.alpha()));
+//   clock.endCpuWork();    // right before swapBuffers
+//   window.swapBuffers();
+//   clock.markPresent();   // right after it
+//
+// When the swap happens on another thread, pass its times in as they come back.
+class FrameClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FrameClock(double fixedStepSeconds = 1.0 / 120.0, int maxStepsPerFrame = 8);
+
+    void beginFrame();
+    // Forget the time since the last frame (the loop was idle on purpose), the next
+    // frame simulates a single step and no present interval is recorded for the gap
+    void resync();
+    // Consumes one fixed step from the accumulator, call until it returns false
+    bool step();
+    // How far the frame is between the last two simulation states, [0, 1)
+    float alpha() const { return static_cast<float>(accumulator / fixedStepSeconds); }
+
+    void endCpuWork();
+    void markPresent(Clock::time_point when = Clock::now());
+
+    double fixedStep() const { return fixedStepSeconds; }
+    double frameSeconds() const { return frameDelta; }
+    double totalSeconds() const { return simulatedTime; }
+    uint64_t frameIndex() const { return frames; }
+    uint64_t droppedSteps() const { return dropped; }
+
+    const FrameTimeHistogram& cpuFrameTimes() const { return cpuTimes; }
+    const FrameTimeHistogram& presentIntervals() const { return presentTimes; }
+
+    void print(std::ostream& out) const;
+private:
+    static double millis(Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); }
+
+    double fixedStepSeconds;
+    int maxStepsPerFrame;
+
+    Clock::time_point frameStart;
+    Clock::time_point lastFrameStart;
+    Clock::time_point lastPresent;
+    bool started = false;
+    bool presented = false;
+
+    double frameDelta = 0.0;
+    double accumulator = 0.0;
+    double simulatedTime = 0.0;
+    int stepsThisFrame = 0;
+    uint64_t frames = 0;
+    uint64_t dropped = 0;
+
+    FrameTimeHistogram cpuTimes;
+    FrameTimeHistogram presentTimes;
+};
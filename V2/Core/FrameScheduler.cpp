@@ -0,0 +1,66 @@
+#include "FrameScheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+int FrameScheduler::waitTimeoutMs() const {
+    wakeups++;
+    if (!due()) {
+        return idleWaitMs;
+    }
+    if (!rendered || minInterval() <= 0.0) {
+        return 0;
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - lastFrame).count();
+    double remaining = minInterval() - elapsed;
+    if (remaining <= 0.0) {
+        return 0;
+    }
+    return std::min(idleWaitMs, static_cast<int>(std::ceil(remaining * 1000.0)));
+}
+
+bool FrameScheduler::beginFrame() {
+    if (!due()) {
+        return false;
+    }
+    Clock::time_point now = Clock::now();
+    double elapsed = rendered ? std::chrono::duration<double>(now - lastFrame).count() : 0.0;
+    if (rendered && elapsed < minInterval()) {
+        return false;
+    }
+
+    // anything longer than a couple of throttled frames means the loop was sleeping in between
+    resumed = !rendered || elapsed > 2.0 / unfocusedHz;
+    dirty = false;
+    frameStart = now;
+    return true;
+}
+
+void FrameScheduler::endFrame() {
+    Clock::time_point now = Clock::now();
+    busyMs += std::chrono::duration<double, std::milli>(now - frameStart).count();
+    lastFrame = frameStart;
+    rendered = true;
+    frames++;
+}
+
+Utilization FrameScheduler::takeUtilization() {
+    Clock::time_point now = Clock::now();
+    double wallMs = std::chrono::duration<double, std::milli>(now - sampleStart).count();
+
+    Utilization u;
+    if (wallMs > 0.0) {
+        u.fps = frames * 1000.0 / wallMs;
+        u.cpuBusyPercent = 100.0 * busyMs / wallMs;
+        u.gpuBusyPercent = 100.0 * gpuMs / wallMs;
+    }
+    u.frames = frames;
+    u.wakeups = wakeups;
+
+    sampleStart = now;
+    busyMs = 0.0;
+    gpuMs = 0.0;
+    frames = 0;
+    wakeups = 0;
+    return u;
+}
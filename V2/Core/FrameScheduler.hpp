@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+struct Utilization {
+    double fps = 0.0;
+    double cpuBusyPercent = 0.0; // main thread time spent inside frames
+    double gpuBusyPercent = 0.0; // from whatever GPU time was reported through addGpuTime
+    uint64_t frames = 0;
+    uint64_t wakeups = 0;        // loop iterations, rendered or not
+};
+
+// Decides when the main loop should render instead of drawing flat out.
+//
+// A frame is due when something invalidated the image or the scene is animating
+// (continuous). While nothing is due the loop should block on window events for
+// waitTimeoutMs(). Unfocused windows are capped to unfocusedHz, minimized ones never render.
+//
+//   window.waitEvents(scheduler.waitTimeoutMs());
+//   if (scheduler.beginFrame()) { draw; scheduler.endFrame(); }
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void invalidate() { dirty = true; }
+    void setContinuous(bool animating) { continuous = animating; }
+    bool isContinuous() const { return continuous; }
+
+    void setFocused(bool value) { focused = value; }
+    void setMinimized(bool value) { minimized = value; }
+
+    // 0 = a frame is due right now, otherwise how long the loop may sleep in the event queue
+    int waitTimeoutMs() const;
+
+    // True when a frame should be rendered now, clears the dirty flag
+    bool beginFrame();
+    void endFrame();
+
+    // True when the previous frame was long enough ago that timing it would be misleading
+    // (the loop was idle), useful for resetting simulation clocks
+    bool resumedFromIdle() const { return resumed; }
+
+    void addGpuTime(double ms) { gpuMs += ms; }
+
+    // Numbers since the last call to takeUtilization()
+    Utilization takeUtilization();
+
+    double unfocusedHz = 10.0;
+    int idleWaitMs = 250; // upper bound on a single wait, keeps stats printing while idle
+private:
+    bool due() const { return !minimized && (dirty || continuous); }
+    double minInterval() const { return focused ? 0.0 : 1.0 / unfocusedHz; }
+
+    bool dirty = true;
+    bool continuous = false;
+    bool focused = true;
+    bool minimized = false;
+    bool resumed = false;
+
+    Clock::time_point lastFrame{};
+    Clock::time_point frameStart{};
+    bool rendered = false;
+
+    Clock::time_point sampleStart = Clock::now();
+    double busyMs = 0.0;
+    double gpuMs = 0.0;
+    uint64_t frames = 0;
+    mutable uint64_t wakeups = 0;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bounded lock-free queue, any number of producers and consumers (Vyukov's design).
+// Each cell carries a sequence number telling whether it is free for the producer
+// or filled for the consumer of a given lap, so push/pop are one CAS each.
+// Capacity is rounded up to a power of two. push() fails instead of blocking when full.
+template <typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    bool push(const T& value) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(T& out) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = cell.value;
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // empty
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t capacity() const { return mask + 1; }
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> tail{ 0 };
+    alignas(64) std::atomic<size_t> head{ 0 };
+};
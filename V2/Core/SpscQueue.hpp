@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread.
+// Each side owns one index and only reads the other's, so there is no CAS at all:
+// push/pop are a load, a store and (when the cached copy of the other index is stale)
+// one more acquire load. Capacity is rounded up to a power of two.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mask = size - 1;
+        slots.reset(new T[size]);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // producer only
+    bool push(const T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - headCache > mask) {
+            headCache = head.load(std::memory_order_acquire);
+            if (t - headCache > mask) {
+                return false; // full
+            }
+        }
+        slots[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only
+    bool pop(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tailCache) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h == tailCache) {
+                return false; // empty
+            }
+        }
+        out = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // exact on the consumer side, a snapshot anywhere else
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+    size_t size() const {
+        size_t h = head.load(std::memory_order_acquire); // head first, tail can only be ahead of it
+        return tail.load(std::memory_order_acquire) - h;
+    }
+    size_t capacity() const { return mask + 1; }
+private:
+    std::unique_ptr<T[]> slots;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> tail{ 0 };
+    size_t headCache = 0; // producer's copy of head
+    alignas(64) std::atomic<size_t> head{ 0 };
+    size_t tailCache = 0; // consumer's copy of tail
+};
@@ -0,0 +1,96 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(unsigned workerCount) {
+    if (workerCount == 0) {
+        unsigned hw = std::thread::hardware_concurrency();
+        workerCount = hw > 1 ? hw - 1 : 0;
+    }
+    for (unsigned i = 0; i < workerCount; i++) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& t : workers) {
+        t.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+    if (workers.empty()) {
+        job(); // single core machine, nobody else would ever pick it up
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push(std::move(job));
+    }
+    cv.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping && jobs.empty()) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop();
+        }
+        job();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (count + grain - 1) / grain;
+
+    if (workers.empty() || chunks == 1) {
+        fn(0, count);
+        return;
+    }
+
+    std::atomic<size_t> next{ 0 };
+    auto body = [&] {
+        size_t chunk;
+        while ((chunk = next.fetch_add(1)) < chunks) {
+            size_t begin = chunk * grain;
+            fn(begin, std::min(begin + grain, count));
+        }
+    };
+
+    // helpers may start after the caller already finished everything,
+    // so wait for all of them before the locals above go out of scope
+    size_t helpers = std::min(workers.size(), chunks - 1);
+    size_t finished = 0;
+    std::mutex doneMutex;
+    std::condition_variable doneCv;
+
+    for (size_t i = 0; i < helpers; i++) {
+        submit([&] {
+            body();
+            std::lock_guard<std::mutex> lock(doneMutex);
+            finished++;
+            doneCv.notify_one();
+        });
+    }
+
+    body();
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCv.wait(lock, [&] { return finished == helpers; });
+}
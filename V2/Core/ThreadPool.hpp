@@ -0,0 +1,38 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads shared by the CPU side systems (transforms, culling, ...).
+class ThreadPool {
+public:
+    // workerCount = 0 picks hardware_concurrency - 1 (the calling thread also works in parallelFor)
+    explicit ThreadPool(unsigned workerCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Workers plus the calling thread
+    unsigned concurrency() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // Fire and forget. Runs inline when there are no workers.
+    void submit(std::function<void()> job);
+
+    // Splits [0, count) into chunks of `grain` and runs fn(begin, end) on them.
+    // Blocks until every chunk is done, the caller works on chunks too.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& fn);
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+
+// Binary layout shared by GLCapture (writer) and Tools/GLReplay (reader).
+//
+//   CaptureHeader
+//   records: uint8 op, uint32 payload size, payload
+//
+// Everything is written in host byte order, captures are meant to be replayed
+// on the machine family they were taken on.
+namespace CaptureFormat {
+    constexpr char kMagic[4] = { 'V', '2', 'C', 'P' };
+    constexpr uint32_t kVersion = 2;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+    };
+
+    enum class Op : uint8_t {
+        CreateBuffer = 1,  // u32 id, bytes
+        CreateVertexArray, // u32 id
+        VertexAttrib,      // VertexAttribRecord
+        CreateTexture,     // u32 id, i32 width, i32 height, RGBA8 bytes (may be empty)
+        CreateProgram,     // u32 id, u32 vertex source length, vertex source, fragment source
+        UseProgram,        // u32 id
+        Uniform1i,         // u32 program, i32 value, name
+        Uniform1f,         // u32 program, f32 value, name
+        UniformMat4,       // u32 program, f32[16], name
+        BindTexture,       // u32 slot, u32 id
+        BindVertexArray,   // u32 id
+        Clear,             // u32 mask, f32[4] color
+        DrawArrays,        // DrawRecord
+        BeginFrame,        // u32 frame, i32[4] viewport
+        EndFrame,          // u32 frame
+        DeleteBuffer,      // u32 id
+        DeleteVertexArray, // u32 id
+        DeleteTexture,     // u32 id
+        Count
+    };
+
+    inline const char* opName(Op op) {
+        switch (op) {
+        case Op::CreateBuffer:      return "CreateBuffer";
+        case Op::CreateVertexArray: return "CreateVertexArray";
+        case Op::VertexAttrib:      return "VertexAttrib";
+        case Op::CreateTexture:     return "CreateTexture";
+        case Op::CreateProgram:     return "CreateProgram";
+        case Op::UseProgram:        return "UseProgram";
+        case Op::Uniform1i:         return "Uniform1i";
+        case Op::Uniform1f:         return "Uniform1f";
+        case Op::UniformMat4:       return "UniformMat4";
+        case Op::BindTexture:       return "BindTexture";
+        case Op::BindVertexArray:   return "BindVertexArray";
+        case Op::Clear:             return "Clear";
+        case Op::DrawArrays:        return "DrawArrays";
+        case Op::BeginFrame:        return "BeginFrame";
+        case Op::EndFrame:          return "EndFrame";
+        case Op::DeleteBuffer:      return "DeleteBuffer";
+        case Op::DeleteVertexArray: return "DeleteVertexArray";
+        case Op::DeleteTexture:     return "DeleteTexture";
+        default:                    return "Unknown";
+        }
+    }
+
+    struct VertexAttribRecord {
+        uint32_t vao;
+        uint32_t vbo;
+        uint32_t index;
+        int32_t count;
+        uint32_t type;
+        uint32_t normalized;
+        int32_t stride;
+        uint64_t offset;
+    };
+
+    // Fixed function state is snapshotted per draw, so state set with raw GL calls
+    // (depth pre-pass, occlusion proxies) replays correctly without wrapping every call
+    struct DrawRecord {
+        uint32_t mode;
+        int32_t first;
+        int32_t count;
+        uint8_t depthTest;
+        uint8_t depthMask;
+        uint8_t blend;
+        uint8_t colorMask; // bit per channel, rgba = 1 2 4 8
+        uint32_t depthFunc;
+        uint32_t blendSrc;
+        uint32_t blendDst;
+    };
+}
@@ -0,0 +1,187 @@
+#include "DebugOutput.hpp"
+
+#if defined(V2_GL_DEBUG)
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include "Core/MpmcQueue.hpp"
+#include "Debug/GLCaps.hpp"
+
+namespace {
+    struct Message {
+        GLenum source;
+        GLenum type;
+        GLenum severity;
+        GLuint id;
+        char text[240];
+    };
+
+    constexpr size_t kQueueSize = 256;
+    constexpr int kMaxIgnoredIds = 32;
+
+    MpmcQueue<Message> queue(kQueueSize);
+    bool initialized = false;
+
+    // read from the driver's threads
+    std::atomic<int> minRank{ 2 }; // medium and up
+    std::atomic<GLuint> ignoredIds[kMaxIgnoredIds];
+    std::atomic<int> ignoredCount{ 0 };
+    std::atomic<uint64_t> received{ 0 };
+    std::atomic<uint64_t> filtered{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+
+    // drain side only
+    std::unordered_map<std::string, uint64_t> seen;
+    uint64_t duplicates = 0;
+
+    int severityRank(GLenum severity) {
+        switch (severity) {
+        case GL_DEBUG_SEVERITY_HIGH:   return 3;
+        case GL_DEBUG_SEVERITY_MEDIUM: return 2;
+        case GL_DEBUG_SEVERITY_LOW:    return 1;
+        default:                       return 0; // notification
+        }
+    }
+
+    const char* sourceName(GLenum source) {
+        switch (source) {
+        case GL_DEBUG_SOURCE_API:             return "api";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   return "window system";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY:     return "third party";
+        case GL_DEBUG_SOURCE_APPLICATION:     return "application";
+        default:                              return "other";
+        }
+    }
+
+    const char* typeName(GLenum type) {
+        switch (type) {
+        case GL_DEBUG_TYPE_ERROR:               return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY:         return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE:         return "performance";
+        case GL_DEBUG_TYPE_PUSH_GROUP:
+        case GL_DEBUG_TYPE_POP_GROUP:           return "group";
+        default:                                return "other";
+        }
+    }
+
+    const char* severityName(GLenum severity) {
+        switch (severity) {
+        case GL_DEBUG_SEVERITY_HIGH:   return "HIGH";
+        case GL_DEBUG_SEVERITY_MEDIUM: return "MEDIUM";
+        case GL_DEBUG_SEVERITY_LOW:    return "LOW";
+        default:                       return "INFO";
+        }
+    }
+
+    void APIENTRY callback(GLenum source, GLenum type, GLuint id, GLenum severity,
+                           GLsizei length, const GLchar* text, const void*) {
+        // the profiler's own push/pop groups echo back as messages
+        if (type == GL_DEBUG_TYPE_PUSH_GROUP || type == GL_DEBUG_TYPE_POP_GROUP ||
+            severityRank(severity) < minRank.load(std::memory_order_relaxed)) {
+            filtered.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        int ignored = ignoredCount.load(std::memory_order_acquire);
+        for (int i = 0; i < ignored; i++) {
+            if (ignoredIds[i].load(std::memory_order_relaxed) == id) {
+                filtered.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        Message m;
+        m.source = source;
+        m.type = type;
+        m.severity = severity;
+        m.id = id;
+        size_t n = length < 0 ? std::strlen(text) : static_cast<size_t>(length);
+        n = n < sizeof(m.text) - 1 ? n : sizeof(m.text) - 1;
+        std::memcpy(m.text, text, n);
+        m.text[n] = '\0';
+
+        received.fetch_add(1, std::memory_order_relaxed);
+        if (!queue.push(m)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void DebugOutput::init() {
+    if (initialized || !GLCaps::get().khrDebug) {
+        return;
+    }
+    // some drivers advertise KHR_debug but glad finds no entry points for it
+    if (!glDebugMessageCallback || !glDebugMessageControl) {
+        std::cerr << "DebugOutput: KHR_debug advertised but glDebugMessageCallback is missing\n";
+        return;
+    }
+    glEnable(GL_DEBUG_OUTPUT);
+    // asynchronous on purpose, synchronous output would serialize the driver again
+    glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(callback, nullptr);
+    initialized = true;
+}
+
+bool DebugOutput::active() {
+    return initialized;
+}
+
+void DebugOutput::setMinSeverity(GLenum severity) {
+    minRank.store(severityRank(severity), std::memory_order_relaxed);
+    if (!initialized) return;
+
+    // let the driver skip generating what we would throw away anyway
+    const GLenum severities[] = {
+        GL_DEBUG_SEVERITY_NOTIFICATION, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_HIGH
+    };
+    for (GLenum s : severities) {
+        GLboolean on = severityRank(s) >= severityRank(severity) ? GL_TRUE : GL_FALSE;
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, s, 0, nullptr, on);
+    }
+}
+
+void DebugOutput::ignoreId(GLuint id) {
+    int count = ignoredCount.load(std::memory_order_relaxed);
+    if (count == kMaxIgnoredIds) return;
+    ignoredIds[count].store(id, std::memory_order_relaxed);
+    ignoredCount.store(count + 1, std::memory_order_release);
+}
+
+void DebugOutput::drain(std::ostream& out) {
+    Message m;
+    while (queue.pop(m)) {
+        std::string key = std::to_string(m.source) + ":" + std::to_string(m.type) + ":" +
+                          std::to_string(m.id) + ":" + m.text;
+        uint64_t& count = seen[key];
+        if (count++ > 0) {
+            duplicates++;
+            continue;
+        }
+        out << "GL " << severityName(m.severity) << " [" << sourceName(m.source) << ", "
+            << typeName(m.type) << ", id " << m.id << "] " << m.text << "\n";
+    }
+}
+
+DebugOutputStats DebugOutput::stats() {
+    DebugOutputStats s;
+    s.received = received.load(std::memory_order_relaxed);
+    s.filtered = filtered.load(std::memory_order_relaxed);
+    s.dropped = dropped.load(std::memory_order_relaxed);
+    s.duplicates = duplicates;
+    return s;
+}
+
+void DebugOutput::label(GLenum identifier, GLuint name, const char* text) {
+    if (GLCaps::get().khrDebug) {
+        glObjectLabel(identifier, name, -1, text);
+    }
+}
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <ostream>
+
+// Debug builds only, unless forced on/off explicitly
+#if !defined(V2_GL_DEBUG) && !defined(NDEBUG) && !defined(V2_NO_GL_DEBUG)
+#define V2_GL_DEBUG 1
+#endif
+
+struct DebugOutputStats {
+    uint64_t received = 0;   // accepted by the callback
+    uint64_t filtered = 0;   // below minSeverity or ignored id
+    uint64_t dropped = 0;    // queue was full
+    uint64_t duplicates = 0; // same message again, only counted
+};
+
+// KHR_debug message pipeline.
+//
+// The driver calls back (possibly from its own threads, output is asynchronous) and the
+// callback only filters and pushes into a lock-free queue. drain(), once per frame, prints
+// each distinct message the first time it shows up and counts the repeats after that.
+// Instead of glGetError after every call, this costs nothing unless the driver has
+// something to say. Without V2_GL_DEBUG every function is an empty inline.
+class DebugOutput {
+public:
+#if defined(V2_GL_DEBUG)
+    // Needs a current context, does nothing without KHR_debug
+    static void init();
+    static bool active();
+
+    // GL_DEBUG_SEVERITY_HIGH / MEDIUM / LOW / NOTIFICATION, everything below is ignored
+    static void setMinSeverity(GLenum severity);
+    static void ignoreId(GLuint id);
+
+    static void drain(std::ostream& out);
+    static DebugOutputStats stats();
+
+    // glObjectLabel when available, shows up in messages and in RenderDoc
+    static void label(GLenum identifier, GLuint name, const char* text);
+#else
+    static void init() {}
+    static bool active() { return false; }
+    static void setMinSeverity(GLenum) {}
+    static void ignoreId(GLuint) {}
+    static void drain(std::ostream&) {}
+    static DebugOutputStats stats() { return {}; }
+    static void label(GLenum, GLuint, const char*) {}
+#endif
+};
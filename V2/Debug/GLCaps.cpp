@@ -0,0 +1,29 @@
+#include "GLCaps.hpp"
+
+#include <glad/glad.h>
+#include <cstring>
+
+bool GLCaps::hasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (ext && std::strcmp(ext, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const GLCaps& GLCaps::get() {
+    static const GLCaps caps = [] {
+        GLCaps c;
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        // core since 4.3, we ask for 4.1 so usually it is the extension
+        c.khrDebug = major > 4 || (major == 4 && minor >= 3) || hasExtension("GL_KHR_debug");
+        return c;
+    }();
+    return caps;
+}
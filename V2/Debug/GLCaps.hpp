@@ -0,0 +1,10 @@
+#pragma once
+
+// Optional GL features the debug tooling uses. Queried once, on first use,
+// so the context has to exist by then.
+struct GLCaps {
+    bool khrDebug = false; // glPushDebugGroup, glObjectLabel, glDebugMessageCallback
+
+    static const GLCaps& get();
+    static bool hasExtension(const char* name);
+};
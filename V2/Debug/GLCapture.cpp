@@ -0,0 +1,282 @@
+#include "GLCapture.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "Debug/CaptureFormat.hpp"
+
+using CaptureFormat::Op;
+
+namespace {
+    constexpr size_t kFlushSize = 1 << 20;
+
+    struct Payload {
+        std::vector<uint8_t> bytes;
+
+        template<typename T>
+        Payload& put(const T& value) {
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+            bytes.insert(bytes.end(), p, p + sizeof(T));
+            return *this;
+        }
+        Payload& putBytes(const void* data, size_t size) {
+            const uint8_t* p = static_cast<const uint8_t*>(data);
+            if (size) bytes.insert(bytes.end(), p, p + size);
+            return *this;
+        }
+    };
+
+    FILE* file = nullptr;
+    std::vector<uint8_t> pending;
+    uint32_t firstFrame = 0;
+    uint32_t endFrameIndex = 0;
+    uint32_t nextFrame = 0;
+    uint32_t currentFrame = 0;
+    bool inWindow = false;
+    size_t bytesWritten = 0;
+
+    // last per-frame state seen before the capture window opened
+    GLuint stickyProgram = 0;
+    GLuint stickyVao = 0;
+    std::map<unsigned, GLuint> stickyTextures;
+    std::map<std::pair<GLuint, std::string>, std::pair<Op, Payload>> stickyUniforms;
+
+    void flush() {
+        if (!pending.empty()) {
+            std::fwrite(pending.data(), 1, pending.size(), file);
+            bytesWritten += pending.size();
+            pending.clear();
+        }
+    }
+
+    void write(Op op, const Payload& payload) {
+        uint32_t size = static_cast<uint32_t>(payload.bytes.size());
+        pending.push_back(static_cast<uint8_t>(op));
+        const uint8_t* s = reinterpret_cast<const uint8_t*>(&size);
+        pending.insert(pending.end(), s, s + sizeof(size));
+        pending.insert(pending.end(), payload.bytes.begin(), payload.bytes.end());
+        if (pending.size() >= kFlushSize) {
+            flush();
+        }
+    }
+
+    void uniform(Op op, GLuint program, const char* name, const void* value, size_t size) {
+        Payload p;
+        p.put(static_cast<uint32_t>(program)).putBytes(value, size).putBytes(name, std::strlen(name));
+        if (inWindow) {
+            write(op, p);
+            return;
+        }
+        stickyUniforms[{ program, name }] = { op, std::move(p) };
+    }
+
+    void writeSticky() {
+        // uniforms apply to the program in use, so switch to each owner first
+        GLuint program = 0;
+        for (const auto& [key, entry] : stickyUniforms) {
+            if (key.first != program) {
+                program = key.first;
+                write(Op::UseProgram, Payload().put(static_cast<uint32_t>(program)));
+            }
+            write(entry.first, entry.second);
+        }
+        for (const auto& [slot, id] : stickyTextures) {
+            write(Op::BindTexture, Payload().put(static_cast<uint32_t>(slot)).put(static_cast<uint32_t>(id)));
+        }
+        write(Op::UseProgram, Payload().put(static_cast<uint32_t>(stickyProgram)));
+        write(Op::BindVertexArray, Payload().put(static_cast<uint32_t>(stickyVao)));
+        stickyUniforms.clear();
+    }
+}
+
+bool GLCapture::start(const char* path, uint32_t first, uint32_t frameCount) {
+    if (recording) {
+        return false;
+    }
+    file = std::fopen(path, "wb");
+    if (!file) {
+        std::cerr << "GLCapture: could not open " << path << "\n";
+        return false;
+    }
+
+    CaptureFormat::Header header;
+    std::memcpy(header.magic, CaptureFormat::kMagic, sizeof(header.magic));
+    header.version = CaptureFormat::kVersion;
+    std::fwrite(&header, sizeof(header), 1, file);
+
+    firstFrame = first;
+    endFrameIndex = first + frameCount;
+    nextFrame = 0;
+    inWindow = false;
+    bytesWritten = sizeof(header);
+    recording = true;
+    return true;
+}
+
+void GLCapture::finish() {
+    if (!recording) return;
+
+    flush();
+    std::fclose(file);
+    file = nullptr;
+    recording = false;
+    inWindow = false;
+    std::cout << "GLCapture: wrote " << bytesWritten << " bytes\n";
+}
+
+void GLCapture::beginFrame() {
+    if (!recording) return;
+
+    currentFrame = nextFrame++;
+    inWindow = currentFrame >= firstFrame && currentFrame < endFrameIndex;
+    if (!inWindow) return;
+
+    GLint viewport[4] = {};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    Payload p;
+    p.put(currentFrame).putBytes(viewport, sizeof(viewport));
+    write(Op::BeginFrame, p);
+
+    if (currentFrame == firstFrame) {
+        writeSticky();
+    }
+}
+
+void GLCapture::endFrame() {
+    if (!recording || !inWindow) return;
+
+    write(Op::EndFrame, Payload().put(currentFrame));
+    if (currentFrame + 1 == endFrameIndex) {
+        finish();
+    }
+}
+
+void GLCapture::recordCreateBuffer(GLuint id, const void* data, size_t size) {
+    write(Op::CreateBuffer, Payload().put(static_cast<uint32_t>(id)).putBytes(data, data ? size : 0));
+}
+
+void GLCapture::recordCreateVertexArray(GLuint id) {
+    write(Op::CreateVertexArray, Payload().put(static_cast<uint32_t>(id)));
+}
+
+void GLCapture::recordVertexAttrib(GLuint vao, GLuint vbo, GLuint index, GLint count, GLenum type,
+                                   GLboolean normalized, GLsizei stride, size_t offset) {
+    CaptureFormat::VertexAttribRecord r{}; // padding included, keeps files reproducible
+    r.vao = vao;
+    r.vbo = vbo;
+    r.index = index;
+    r.count = count;
+    r.type = type;
+    r.normalized = normalized;
+    r.stride = stride;
+    r.offset = offset;
+    write(Op::VertexAttrib, Payload().put(r));
+}
+
+void GLCapture::recordCreateTexture(GLuint id, int width, int height, const void* rgba) {
+    size_t size = rgba ? static_cast<size_t>(width) * height * 4 : 0;
+    Payload p;
+    p.put(static_cast<uint32_t>(id)).put(static_cast<int32_t>(width)).put(static_cast<int32_t>(height)).putBytes(rgba, size);
+    write(Op::CreateTexture, p);
+}
+
+void GLCapture::recordCreateProgram(GLuint id, const std::string& vertexSrc, const std::string& fragmentSrc) {
+    Payload p;
+    p.put(static_cast<uint32_t>(id)).put(static_cast<uint32_t>(vertexSrc.size()))
+     .putBytes(vertexSrc.data(), vertexSrc.size()).putBytes(fragmentSrc.data(), fragmentSrc.size());
+    write(Op::CreateProgram, p);
+}
+
+void GLCapture::recordDeleteBuffer(GLuint id) {
+    write(Op::DeleteBuffer, Payload().put(static_cast<uint32_t>(id)));
+}
+
+void GLCapture::recordDeleteVertexArray(GLuint id) {
+    // deleting a bound vao binds 0, and the id may come back as a different vao
+    if (stickyVao == id) {
+        stickyVao = 0;
+    }
+    write(Op::DeleteVertexArray, Payload().put(static_cast<uint32_t>(id)));
+}
+
+void GLCapture::recordDeleteTexture(GLuint id) {
+    for (auto& [slot, bound] : stickyTextures) {
+        if (bound == id) bound = 0;
+    }
+    write(Op::DeleteTexture, Payload().put(static_cast<uint32_t>(id)));
+}
+
+void GLCapture::recordUseProgram(GLuint id) {
+    if (inWindow) {
+        write(Op::UseProgram, Payload().put(static_cast<uint32_t>(id)));
+    } else {
+        stickyProgram = id;
+    }
+}
+
+void GLCapture::recordUniform1i(GLuint program, const char* name, int value) {
+    int32_t v = value;
+    uniform(Op::Uniform1i, program, name, &v, sizeof(v));
+}
+
+void GLCapture::recordUniform1f(GLuint program, const char* name, float value) {
+    uniform(Op::Uniform1f, program, name, &value, sizeof(value));
+}
+
+void GLCapture::recordUniformMat4(GLuint program, const char* name, const float* m) {
+    uniform(Op::UniformMat4, program, name, m, sizeof(float) * 16);
+}
+
+void GLCapture::recordBindTexture(unsigned slot, GLuint id) {
+    if (inWindow) {
+        write(Op::BindTexture, Payload().put(static_cast<uint32_t>(slot)).put(static_cast<uint32_t>(id)));
+    } else {
+        stickyTextures[slot] = id;
+    }
+}
+
+void GLCapture::recordBindVertexArray(GLuint id) {
+    if (inWindow) {
+        write(Op::BindVertexArray, Payload().put(static_cast<uint32_t>(id)));
+    } else {
+        stickyVao = id;
+    }
+}
+
+void GLCapture::recordClear(GLbitfield mask) {
+    if (!inWindow) return;
+
+    float color[4] = {};
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, color);
+    write(Op::Clear, Payload().put(static_cast<uint32_t>(mask)).putBytes(color, sizeof(color)));
+}
+
+void GLCapture::recordDrawArrays(GLenum mode, GLint first, GLsizei count) {
+    if (!inWindow) return;
+
+    // reading state back is slow, but only ever happens while capturing
+    GLboolean colorMask[4] = {};
+    GLboolean depthMask = GL_TRUE;
+    GLint depthFunc = GL_LESS, blendSrc = GL_ONE, blendDst = GL_ZERO;
+    glGetBooleanv(GL_COLOR_WRITEMASK, colorMask);
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+    glGetIntegerv(GL_BLEND_SRC_RGB, &blendSrc);
+    glGetIntegerv(GL_BLEND_DST_RGB, &blendDst);
+
+    CaptureFormat::DrawRecord r{};
+    r.mode = mode;
+    r.first = first;
+    r.count = count;
+    r.depthTest = glIsEnabled(GL_DEPTH_TEST);
+    r.depthMask = depthMask;
+    r.blend = glIsEnabled(GL_BLEND);
+    r.colorMask = (colorMask[0] ? 1 : 0) | (colorMask[1] ? 2 : 0) | (colorMask[2] ? 4 : 0) | (colorMask[3] ? 8 : 0);
+    r.depthFunc = static_cast<uint32_t>(depthFunc);
+    r.blendSrc = static_cast<uint32_t>(blendSrc);
+    r.blendDst = static_cast<uint32_t>(blendDst);
+    write(Op::DrawArrays, Payload().put(r));
+}
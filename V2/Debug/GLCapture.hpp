@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Records what goes through the wrappers into a capture file for Tools/GLReplay.
+//
+// Call start() before any GL object is created: buffer, texture and program creation is
+// recorded from then on (with contents) so the capture is self-contained, and so are deletes,
+// since GL hands a deleted object's id out again. Per-frame
+// commands are only written for frames [firstFrame, firstFrame + frameCount); before that
+// the last bound program / textures / vao and uniform values are remembered and written
+// at the start of the first captured frame. The file is closed after the last frame.
+//
+// Not captured: queries, conditional rendering and anything the wrappers don't see,
+// except depth / blend / color mask state which is read back at every draw.
+// Every hook is a single branch while nothing is being captured.
+class GLCapture {
+public:
+    static bool start(const char* path, uint32_t firstFrame, uint32_t frameCount);
+    static void finish();
+    static bool active() { return recording; }
+
+    static void beginFrame();
+    static void endFrame();
+
+    static void createBuffer(GLuint id, const void* data, size_t size) { if (recording) recordCreateBuffer(id, data, size); }
+    static void createVertexArray(GLuint id) { if (recording) recordCreateVertexArray(id); }
+    static void vertexAttrib(GLuint vao, GLuint vbo, GLuint index, GLint count, GLenum type,
+                             GLboolean normalized, GLsizei stride, size_t offset) {
+        if (recording) recordVertexAttrib(vao, vbo, index, count, type, normalized, stride, offset);
+    }
+    static void createTexture(GLuint id, int width, int height, const void* rgba) { if (recording) recordCreateTexture(id, width, height, rgba); }
+    static void createProgram(GLuint id, const std::string& vertexSrc, const std::string& fragmentSrc) {
+        if (recording) recordCreateProgram(id, vertexSrc, fragmentSrc);
+    }
+    static void deleteBuffer(GLuint id) { if (recording) recordDeleteBuffer(id); }
+    static void deleteVertexArray(GLuint id) { if (recording) recordDeleteVertexArray(id); }
+    static void deleteTexture(GLuint id) { if (recording) recordDeleteTexture(id); }
+
+    static void useProgram(GLuint id) { if (recording) recordUseProgram(id); }
+    static void uniform1i(GLuint program, const char* name, int value) { if (recording) recordUniform1i(program, name, value); }
+    static void uniform1f(GLuint program, const char* name, float value) { if (recording) recordUniform1f(program, name, value); }
+    static void uniformMat4(GLuint program, const char* name, const float* m) { if (recording) recordUniformMat4(program, name, m); }
+    static void bindTexture(unsigned slot, GLuint id) { if (recording) recordBindTexture(slot, id); }
+    static void bindVertexArray(GLuint id) { if (recording) recordBindVertexArray(id); }
+
+    static void clear(GLbitfield mask) { if (recording) recordClear(mask); }
+    static void drawArrays(GLenum mode, GLint first, GLsizei count) { if (recording) recordDrawArrays(mode, first, count); }
+private:
+    static inline bool recording = false;
+
+    static void recordCreateBuffer(GLuint id, const void* data, size_t size);
+    static void recordCreateVertexArray(GLuint id);
+    static void recordVertexAttrib(GLuint vao, GLuint vbo, GLuint index, GLint count, GLenum type,
+                                   GLboolean normalized, GLsizei stride, size_t offset);
+    static void recordCreateTexture(GLuint id, int width, int height, const void* rgba);
+    static void recordCreateProgram(GLuint id, const std::string& vertexSrc, const std::string& fragmentSrc);
+    static void recordDeleteBuffer(GLuint id);
+    static void recordDeleteVertexArray(GLuint id);
+    static void recordDeleteTexture(GLuint id);
+    static void recordUseProgram(GLuint id);
+    static void recordUniform1i(GLuint program, const char* name, int value);
+    static void recordUniform1f(GLuint program, const char* name, float value);
+    static void recordUniformMat4(GLuint program, const char* name, const float* m);
+    static void recordBindTexture(unsigned slot, GLuint id);
+    static void recordBindVertexArray(GLuint id);
+    static void recordClear(GLbitfield mask);
+    static void recordDrawArrays(GLenum mode, GLint first, GLsizei count);
+};
@@ -0,0 +1,236 @@
+#include "Profiler.hpp"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+
+#include "Debug/GLCaps.hpp"
+
+Profiler& Profiler::get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+double Profiler::nowUs() const {
+    return std::chrono::duration<double, std::micro>(Clock::now() - epoch).count();
+}
+
+void Profiler::initGpu() {
+    owner = std::this_thread::get_id();
+    gpu = true;
+    debugGroups = GLCaps::get().khrDebug;
+
+    // line the GPU clock up with the CPU one, good to a few microseconds
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    gpuEpochNs = gpuNow - static_cast<int64_t>(nowUs() * 1000.0);
+}
+
+unsigned int Profiler::nextQuery() {
+    GLuint q = 0;
+    if (freeQueries.empty()) {
+        glGenQueries(1, &q);
+    } else {
+        q = freeQueries.back();
+        freeQueries.pop_back();
+    }
+    current.queries.push_back(q);
+    return q;
+}
+
+void Profiler::endCurrent() {
+    if (!current.events.empty()) {
+        pending.push_back(std::move(current));
+    }
+    current = Frame();
+}
+
+void Profiler::beginFrame() {
+    if (!enabled) return;
+
+    owner = std::this_thread::get_id();
+    endCurrent();
+    while (!pending.empty()) {
+        bool ready = available(pending.front());
+        if (!ready && pending.size() <= kFramesInFlight) break;
+        if (!ready) droppedGpuFrames++;
+        resolve(pending.front(), ready);
+        pending.pop_front();
+    }
+    current.frame = ++frame;
+    open.clear();
+}
+
+void Profiler::endFrame() {
+    if (!onOwnerThread()) return;
+
+    // scopes left open are closed at the frame boundary so the slot stays consistent
+    while (!open.empty()) {
+        endScope();
+    }
+}
+
+void Profiler::beginScope(const char* name) {
+    if (!enabled || !onOwnerThread()) return;
+
+    Event e;
+    e.name = name;
+    e.depth = static_cast<uint32_t>(open.size());
+    e.cpuBeginUs = nowUs();
+    e.cpuEndUs = e.cpuBeginUs;
+    e.gpuBeginUs = e.gpuEndUs = -1.0;
+    e.beginQuery = e.endQuery = -1;
+
+    if (gpu) {
+        if (debugGroups) {
+            glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+        }
+        e.beginQuery = static_cast<int32_t>(current.queries.size());
+        glQueryCounter(nextQuery(), GL_TIMESTAMP);
+    }
+
+    open.push_back(current.events.size());
+    current.events.push_back(e);
+}
+
+void Profiler::endScope() {
+    // open belongs to the owner thread, other threads must not even look at it
+    if (!onOwnerThread() || open.empty()) return;
+
+    Event& e = current.events[open.back()];
+    open.pop_back();
+
+    if (e.beginQuery >= 0) {
+        e.endQuery = static_cast<int32_t>(current.queries.size());
+        glQueryCounter(nextQuery(), GL_TIMESTAMP);
+        if (debugGroups) {
+            glPopDebugGroup();
+        }
+    }
+    e.cpuEndUs = nowUs();
+}
+
+bool Profiler::available(const Frame& f) const {
+    if (f.queries.empty()) return true;
+
+    // queries finish in order, so the last one tells for the whole frame
+    GLuint available = 0;
+    glGetQueryObjectuiv(f.queries.back(), GL_QUERY_RESULT_AVAILABLE, &available);
+    return available != 0;
+}
+
+void Profiler::resolve(Frame& f, bool gpuReady) {
+    for (Event& e : f.events) {
+        bool hasGpu = gpuReady && e.beginQuery >= 0 && e.endQuery >= 0;
+        if (hasGpu) {
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(f.queries[e.beginQuery], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(f.queries[e.endQuery], GL_QUERY_RESULT, &end);
+            e.gpuBeginUs = (static_cast<int64_t>(begin) - gpuEpochNs) / 1000.0;
+            e.gpuEndUs = (static_cast<int64_t>(end) - gpuEpochNs) / 1000.0;
+        } else {
+            e.gpuBeginUs = e.gpuEndUs = -1.0;
+        }
+
+        Accum& a = totals[e.name];
+        double cpuMs = (e.cpuEndUs - e.cpuBeginUs) / 1000.0;
+        a.calls++;
+        a.cpuMs += cpuMs;
+        a.cpuMaxMs = std::max(a.cpuMaxMs, cpuMs);
+        if (hasGpu) {
+            double gpuMs = (e.gpuEndUs - e.gpuBeginUs) / 1000.0;
+            a.gpuCalls++;
+            a.gpuMs += gpuMs;
+            a.gpuMaxMs = std::max(a.gpuMaxMs, gpuMs);
+        }
+
+        if (trace.size() < maxTraceEvents) {
+            trace.push_back(e);
+        }
+    }
+
+    if (f.queries.empty()) return;
+    if (gpuReady) {
+        freeQueries.insert(freeQueries.end(), f.queries.begin(), f.queries.end());
+    } else {
+        // still in flight, issuing them again would mix up the results
+        glDeleteQueries(static_cast<GLsizei>(f.queries.size()), f.queries.data());
+    }
+    f.queries.clear();
+}
+
+void Profiler::flush() {
+    if (open.empty()) {
+        endCurrent();
+    }
+    // GL_QUERY_RESULT waits for the GPU, fine here but never in beginFrame()
+    for (Frame& f : pending) {
+        resolve(f, true);
+    }
+    pending.clear();
+}
+
+std::vector<ProfileScopeStats> Profiler::summary() const {
+    std::vector<ProfileScopeStats> out;
+    for (const auto& [name, a] : totals) {
+        ProfileScopeStats s;
+        s.name = name;
+        s.calls = a.calls;
+        s.cpuAvgMs = a.calls ? a.cpuMs / a.calls : 0.0;
+        s.cpuMaxMs = a.cpuMaxMs;
+        s.gpuAvgMs = a.gpuCalls ? a.gpuMs / a.gpuCalls : 0.0;
+        s.gpuMaxMs = a.gpuMaxMs;
+        out.push_back(s);
+    }
+    return out;
+}
+
+void Profiler::printSummary(std::ostream& out) {
+    flush();
+    out << std::left << std::setw(28) << "scope" << std::right
+        << std::setw(8) << "calls" << std::setw(12) << "cpu avg" << std::setw(12) << "cpu max"
+        << std::setw(12) << "gpu avg" << std::setw(12) << "gpu max" << "\n";
+    for (const ProfileScopeStats& s : summary()) {
+        out << std::left << std::setw(28) << s.name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(8) << s.calls << std::setw(12) << s.cpuAvgMs << std::setw(12) << s.cpuMaxMs
+            << std::setw(12) << s.gpuAvgMs << std::setw(12) << s.gpuMaxMs << "\n";
+    }
+    out << std::defaultfloat;
+    if (droppedGpuFrames) {
+        out << droppedGpuFrames << " frames lost their GPU times (results not ready in time)\n";
+    }
+}
+
+void Profiler::resetSummary() {
+    totals.clear();
+    droppedGpuFrames = 0;
+}
+
+void Profiler::clearTrace() {
+    trace.clear();
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+    flush();
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+
+    // complete ("X") events, pid 1, tid 1 = CPU, tid 2 = GPU
+    std::fprintf(file, "{\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+    for (const Event& e : trace) {
+        std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                     e.name, e.cpuBeginUs, e.cpuEndUs - e.cpuBeginUs);
+        if (e.gpuBeginUs >= 0.0) {
+            std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f}",
+                         e.name, e.gpuBeginUs, e.gpuEndUs - e.gpuBeginUs);
+        }
+    }
+    std::fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    std::fclose(file);
+    return true;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ProfileScopeStats {
+    std::string name;
+    uint64_t calls = 0;
+    double cpuAvgMs = 0.0;
+    double cpuMaxMs = 0.0;
+    double gpuAvgMs = 0.0; // 0 when the scope never had GPU timestamps
+    double gpuMaxMs = 0.0;
+};
+
+// Frame profiler for the GL thread.
+//
+// Every scope records CPU time with steady_clock and, once initGpu() ran, a pair of
+// GL_TIMESTAMP queries. Timestamps nest fine (unlike GL_TIME_ELAPSED). Ended frames queue
+// up until their last query is available and are read back then; query objects only go
+// back to the pool once read. A frame still not done kFramesInFlight frames later loses its
+// GPU times instead of stalling. With KHR_debug each scope is also a debug group, so it
+// shows up in RenderDoc / Nsight captures.
+//
+// Scopes only count on the thread that owns the GL context: the one that called initGpu(),
+// then whichever calls beginFrame(). Scopes opened anywhere else (ResourceLoader) are ignored.
+// Names must outlive the profiler (string literals).
+class Profiler {
+public:
+    static Profiler& get();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Needs a current context, scopes before this call are CPU only
+    void initGpu();
+
+    void beginFrame();
+    void endFrame();
+
+    void beginScope(const char* name);
+    void endScope();
+
+    // Reads back every ended frame, waiting for the GPU where it has to. Needs the context.
+    // printSummary() and writeChromeTrace() call it so the last frames are not missing.
+    void flush();
+
+    // Per-scope numbers since the last resetSummary(), sorted by name
+    std::vector<ProfileScopeStats> summary() const;
+    void printSummary(std::ostream& out);
+    void resetSummary();
+
+    // chrome://tracing / Perfetto JSON, CPU scopes on one track and GPU scopes on another
+    bool writeChromeTrace(const std::string& path);
+    void clearTrace();
+
+    bool enabled = true;
+    size_t maxTraceEvents = 200000; // recording stops once the trace holds this many
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int kFramesInFlight = 3;
+
+    struct Event {
+        const char* name;
+        uint32_t depth;
+        double cpuBeginUs;
+        double cpuEndUs;
+        double gpuBeginUs;
+        double gpuEndUs;
+        int32_t beginQuery; // indices into the frame's queries, -1 = CPU only
+        int32_t endQuery;
+    };
+
+    struct Frame {
+        uint64_t frame = 0;
+        std::vector<Event> events;
+        std::vector<unsigned int> queries;
+    };
+
+    struct Accum {
+        uint64_t calls = 0;
+        uint64_t gpuCalls = 0;
+        double cpuMs = 0.0, cpuMaxMs = 0.0;
+        double gpuMs = 0.0, gpuMaxMs = 0.0;
+    };
+
+    Profiler() = default;
+
+    double nowUs() const;
+    bool onOwnerThread() const { return owner.load(std::memory_order_relaxed) == std::this_thread::get_id(); }
+    unsigned int nextQuery();
+    void endCurrent();
+    bool available(const Frame& f) const;
+    void resolve(Frame& f, bool gpuReady);
+
+    Clock::time_point epoch = Clock::now();
+    std::atomic<std::thread::id> owner{ std::this_thread::get_id() };
+    bool gpu = false;
+    bool debugGroups = false;
+    int64_t gpuEpochNs = 0; // GL_TIMESTAMP matching epoch
+
+    Frame current;
+    std::deque<Frame> pending; // ended, oldest first, queries possibly still in flight
+    std::vector<unsigned int> freeQueries; // read back, safe to issue again
+    uint64_t frame = 0;
+    std::vector<size_t> open; // indices into current.events
+    uint64_t droppedGpuFrames = 0;
+
+    std::vector<Event> trace;
+    std::map<std::string, Accum> totals;
+};
+
+struct ProfileScope {
+    explicit ProfileScope(const char* name) { Profiler::get().beginScope(name); }
+    ~ProfileScope() { Profiler::get().endScope(); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if defined(V2_NO_PROFILER)
+#define PROFILE_SCOPE(name) ((void)0)
+#else
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#endif
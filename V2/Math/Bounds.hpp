@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cfloat>
+#include <cmath>
+#include "Math/Math.hpp"
+
+struct AABB {
+    Vec3 min{ FLT_MAX, FLT_MAX, FLT_MAX };
+    Vec3 max{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    bool valid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    Vec3 center() const { return (min + max) * 0.5f; }
+    Vec3 extents() const { return (max - min) * 0.5f; }
+
+    void expand(const Vec3& p) {
+        min = minVec(min, p);
+        max = maxVec(max, p);
+    }
+
+    void expand(const AABB& b) {
+        min = minVec(min, b.min);
+        max = maxVec(max, b.max);
+    }
+
+    float surfaceArea() const {
+        Vec3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    bool overlaps(const AABB& b) const {
+        return min.x <= b.max.x && max.x >= b.min.x &&
+               min.y <= b.max.y && max.y >= b.min.y &&
+               min.z <= b.max.z && max.z >= b.min.z;
+    }
+
+    // Box around this box after transforming it by m (Arvo's method, center/extents form)
+    AABB transformed(const Mat4& m) const {
+        Vec3 c = transformPoint(m, center());
+        Vec3 e = extents();
+        Vec3 r(
+            std::fabs(m.m[0]) * e.x + std::fabs(m.m[4]) * e.y + std::fabs(m.m[8])  * e.z,
+            std::fabs(m.m[1]) * e.x + std::fabs(m.m[5]) * e.y + std::fabs(m.m[9])  * e.z,
+            std::fabs(m.m[2]) * e.x + std::fabs(m.m[6]) * e.y + std::fabs(m.m[10]) * e.z);
+        AABB out;
+        out.min = c - r;
+        out.max = c + r;
+        return out;
+    }
+};
+
+struct BoundingSphere {
+    Vec3 center;
+    float radius = 0.0f;
+};
+
+// Six planes (a, b, c, d) with ax + by + cz + d >= 0 meaning inside.
+// Order: left, right, bottom, top, near, far.
+struct Frustum {
+    Vec4 planes[6];
+
+    // Gribb/Hartmann extraction from a (projection * view) matrix, GL clip space
+    static Frustum fromMatrix(const Mat4& vp) {
+        auto row = [&](int r) { return Vec4(vp(r, 0), vp(r, 1), vp(r, 2), vp(r, 3)); };
+        Vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+        Frustum f;
+        f.planes[0] = r3 + r0;
+        f.planes[1] = r3 + r0 * -1.0f;
+        f.planes[2] = r3 + r1;
+        f.planes[3] = r3 + r1 * -1.0f;
+        f.planes[4] = r3 + r2;
+        f.planes[5] = r3 + r2 * -1.0f;
+
+        for (Vec4& p : f.planes) {
+            float len = length(p.xyz());
+            if (len > 0.0f) p = p * (1.0f / len);
+        }
+        return f;
+    }
+
+    bool intersects(const AABB& box) const {
+        Vec3 c = box.center(), e = box.extents();
+        for (const Vec4& p : planes) {
+            float d = p.x * c.x + p.y * c.y + p.z * c.z + p.w;
+            float r = std::fabs(p.x) * e.x + std::fabs(p.y) * e.y + std::fabs(p.z) * e.z;
+            if (d + r < 0.0f) return false;
+        }
+        return true;
+    }
+};
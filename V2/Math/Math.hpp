@@ -0,0 +1,230 @@
+#pragma once
+
+#include <cmath>
+#include "Math/Simd.hpp"
+
+// Small vector / matrix types for transforms.
+// Everything is column-major so a Mat4 can go straight into glUniformMatrix4fv (transpose = GL_FALSE).
+
+struct alignas(16) Vec3 {
+    float x = 0, y = 0, z = 0;
+    float pad = 0; // keeps Vec3 16 byte sized so it loads as one register
+
+    Vec3() = default;
+    Vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+};
+
+inline Vec3 operator+(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+inline Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+inline Vec3 operator*(const Vec3& a, float s)       { return { a.x * s, a.y * s, a.z * s }; }
+inline Vec3 operator*(const Vec3& a, const Vec3& b) { return { a.x * b.x, a.y * b.y, a.z * b.z }; }
+
+inline float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3 cross(const Vec3& a, const Vec3& b) {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+inline float length(const Vec3& a) { return std::sqrt(dot(a, a)); }
+inline Vec3 normalize(const Vec3& a) {
+    float len = length(a);
+    return len > 0.0f ? a * (1.0f / len) : a;
+}
+inline Vec3 minVec(const Vec3& a, const Vec3& b) {
+    return { a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z };
+}
+inline Vec3 maxVec(const Vec3& a, const Vec3& b) {
+    return { a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z };
+}
+
+struct alignas(16) Vec4 {
+    float x = 0, y = 0, z = 0, w = 0;
+
+    Vec4() = default;
+    Vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    Vec4(const Vec3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+
+    Vec3 xyz() const { return { x, y, z }; }
+};
+
+inline Vec4 operator+(const Vec4& a, const Vec4& b) { return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w }; }
+inline Vec4 operator*(const Vec4& a, float s)       { return { a.x * s, a.y * s, a.z * s, a.w * s }; }
+inline float dot(const Vec4& a, const Vec4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+struct alignas(16) Quat {
+    float x = 0, y = 0, z = 0, w = 1;
+
+    Quat() = default;
+    Quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+    static Quat fromAxisAngle(const Vec3& axis, float radians) {
+        Vec3 n = normalize(axis);
+        float s = std::sin(radians * 0.5f);
+        return { n.x * s, n.y * s, n.z * s, std::cos(radians * 0.5f) };
+    }
+};
+
+inline Quat operator*(const Quat& a, const Quat& b) {
+    return {
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+    };
+}
+
+inline Quat normalize(const Quat& q) {
+    float len = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    float inv = len > 0.0f ? 1.0f / len : 0.0f;
+    return { q.x * inv, q.y * inv, q.z * inv, q.w * inv };
+}
+
+inline Vec3 rotate(const Quat& q, const Vec3& v) {
+    // v' = v + 2w(u x v) + 2(u x (u x v))
+    Vec3 u(q.x, q.y, q.z);
+    Vec3 t = cross(u, v) * 2.0f;
+    return v + t * q.w + cross(u, t);
+}
+
+struct alignas(16) Mat4 {
+    float m[16]; // m[col * 4 + row]
+
+    const float* data() const { return m; }
+    float* data() { return m; }
+
+    float& operator()(int row, int col)       { return m[col * 4 + row]; }
+    float  operator()(int row, int col) const { return m[col * 4 + row]; }
+
+    static Mat4 identity() {
+        Mat4 r{};
+        r.m[0] = r.m[5] = r.m[10] = r.m[15] = 1.0f;
+        return r;
+    }
+
+    static Mat4 translation(const Vec3& t) {
+        Mat4 r = identity();
+        r.m[12] = t.x; r.m[13] = t.y; r.m[14] = t.z;
+        return r;
+    }
+
+    static Mat4 scale(const Vec3& s) {
+        Mat4 r{};
+        r.m[0] = s.x; r.m[5] = s.y; r.m[10] = s.z; r.m[15] = 1.0f;
+        return r;
+    }
+
+    static Mat4 rotationZ(float radians) {
+        float c = std::cos(radians), s = std::sin(radians);
+        Mat4 r = identity();
+        r.m[0] = c;  r.m[1] = s;
+        r.m[4] = -s; r.m[5] = c;
+        return r;
+    }
+
+    // T * R * S
+    static Mat4 fromTRS(const Vec3& t, const Quat& q, const Vec3& s) {
+        float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+        Mat4 r;
+        r.m[0]  = (1.0f - 2.0f * (yy + zz)) * s.x;
+        r.m[1]  = (2.0f * (xy + wz)) * s.x;
+        r.m[2]  = (2.0f * (xz - wy)) * s.x;
+        r.m[3]  = 0.0f;
+        r.m[4]  = (2.0f * (xy - wz)) * s.y;
+        r.m[5]  = (1.0f - 2.0f * (xx + zz)) * s.y;
+        r.m[6]  = (2.0f * (yz + wx)) * s.y;
+        r.m[7]  = 0.0f;
+        r.m[8]  = (2.0f * (xz + wy)) * s.z;
+        r.m[9]  = (2.0f * (yz - wx)) * s.z;
+        r.m[10] = (1.0f - 2.0f * (xx + yy)) * s.z;
+        r.m[11] = 0.0f;
+        r.m[12] = t.x;
+        r.m[13] = t.y;
+        r.m[14] = t.z;
+        r.m[15] = 1.0f;
+        return r;
+    }
+
+    // OpenGL style clip space (z in [-1, 1])
+    static Mat4 perspective(float fovYRadians, float aspect, float zNear, float zFar) {
+        float f = 1.0f / std::tan(fovYRadians * 0.5f);
+        Mat4 r{};
+        r.m[0]  = f / aspect;
+        r.m[5]  = f;
+        r.m[10] = (zFar + zNear) / (zNear - zFar);
+        r.m[11] = -1.0f;
+        r.m[14] = (2.0f * zFar * zNear) / (zNear - zFar);
+        return r;
+    }
+
+    static Mat4 lookAt(const Vec3& eye, const Vec3& target, const Vec3& up) {
+        Vec3 f = normalize(target - eye);
+        Vec3 s = normalize(cross(f, up));
+        Vec3 u = cross(s, f);
+        Mat4 r = identity();
+        r.m[0] = s.x;  r.m[4] = s.y;  r.m[8]  = s.z;
+        r.m[1] = u.x;  r.m[5] = u.y;  r.m[9]  = u.z;
+        r.m[2] = -f.x; r.m[6] = -f.y; r.m[10] = -f.z;
+        r.m[12] = -dot(s, eye);
+        r.m[13] = -dot(u, eye);
+        r.m[14] = dot(f, eye);
+        return r;
+    }
+};
+
+inline Mat4 mulScalar(const Mat4& a, const Mat4& b) {
+    Mat4 r;
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            r.m[col * 4 + row] =
+                a.m[0 * 4 + row] * b.m[col * 4 + 0] +
+                a.m[1 * 4 + row] * b.m[col * 4 + 1] +
+                a.m[2 * 4 + row] * b.m[col * 4 + 2] +
+                a.m[3 * 4 + row] * b.m[col * 4 + 3];
+        }
+    }
+    return r;
+}
+
+inline Mat4 operator*(const Mat4& a, const Mat4& b) {
+#if defined(MATH_SIMD)
+    // each result column is a linear combination of a's columns
+    F4 a0 = F4::loadA(a.m + 0);
+    F4 a1 = F4::loadA(a.m + 4);
+    F4 a2 = F4::loadA(a.m + 8);
+    F4 a3 = F4::loadA(a.m + 12);
+
+    Mat4 r;
+    for (int col = 0; col < 4; col++) {
+        F4 bc = F4::loadA(b.m + col * 4);
+        F4 c = a0 * splat<0>(bc) + a1 * splat<1>(bc) + a2 * splat<2>(bc) + a3 * splat<3>(bc);
+        c.storeA(r.m + col * 4);
+    }
+    return r;
+#else
+    return mulScalar(a, b);
+#endif
+}
+
+inline Vec4 operator*(const Mat4& a, const Vec4& v) {
+#if defined(MATH_SIMD)
+    alignas(16) float in[4] = { v.x, v.y, v.z, v.w };
+    F4 vv = F4::loadA(in);
+    F4 c = F4::loadA(a.m + 0) * splat<0>(vv) + F4::loadA(a.m + 4) * splat<1>(vv) +
+           F4::loadA(a.m + 8) * splat<2>(vv) + F4::loadA(a.m + 12) * splat<3>(vv);
+    Vec4 r;
+    c.storeA(&r.x);
+    return r;
+#else
+    return {
+        a.m[0] * v.x + a.m[4] * v.y + a.m[8]  * v.z + a.m[12] * v.w,
+        a.m[1] * v.x + a.m[5] * v.y + a.m[9]  * v.z + a.m[13] * v.w,
+        a.m[2] * v.x + a.m[6] * v.y + a.m[10] * v.z + a.m[14] * v.w,
+        a.m[3] * v.x + a.m[7] * v.y + a.m[11] * v.z + a.m[15] * v.w
+    };
+#endif
+}
+
+inline Vec3 transformPoint(const Mat4& a, const Vec3& p) {
+    return (a * Vec4(p, 1.0f)).xyz();
+}
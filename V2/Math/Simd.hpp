@@ -0,0 +1,92 @@
+#pragma once
+
+// Picks the widest instruction set the compiler was told about.
+// MSVC on x64 always has SSE2, gcc/clang define __SSE2__ / __AVX__ from -m flags.
+#if defined(__AVX__)
+    #define MATH_SIMD_AVX 1
+    #define MATH_SIMD_SSE 1
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define MATH_SIMD_SSE 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define MATH_SIMD_NEON 1
+    #include <arm_neon.h>
+#endif
+
+#if defined(MATH_NO_SIMD)
+    #undef MATH_SIMD_AVX
+    #undef MATH_SIMD_SSE
+    #undef MATH_SIMD_NEON
+#endif
+
+#if defined(MATH_SIMD_SSE) || defined(MATH_SIMD_NEON)
+    #define MATH_SIMD 1
+#endif
+
+// 4 wide float lanes. Only the handful of ops the math code actually needs.
+#if defined(MATH_SIMD_SSE)
+struct F4 {
+    __m128 v;
+
+    static F4 load(const float* p)  { return { _mm_loadu_ps(p) }; }
+    static F4 loadA(const float* p) { return { _mm_load_ps(p) }; }
+    static F4 set1(float f)         { return { _mm_set1_ps(f) }; }
+    void store(float* p) const      { _mm_storeu_ps(p, v); }
+    void storeA(float* p) const     { _mm_store_ps(p, v); }
+};
+
+inline F4 operator+(F4 a, F4 b) { return { _mm_add_ps(a.v, b.v) }; }
+inline F4 operator-(F4 a, F4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline F4 operator*(F4 a, F4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+
+// broadcasts lane i of a
+template<int i>
+inline F4 splat(F4 a) { return { _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(i, i, i, i)) }; }
+
+inline void transpose(F4& a, F4& b, F4& c, F4& d) {
+    _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+}
+#elif defined(MATH_SIMD_NEON)
+struct F4 {
+    float32x4_t v;
+
+    static F4 load(const float* p)  { return { vld1q_f32(p) }; }
+    static F4 loadA(const float* p) { return { vld1q_f32(p) }; }
+    static F4 set1(float f)         { return { vdupq_n_f32(f) }; }
+    void store(float* p) const      { vst1q_f32(p, v); }
+    void storeA(float* p) const     { vst1q_f32(p, v); }
+};
+
+inline F4 operator+(F4 a, F4 b) { return { vaddq_f32(a.v, b.v) }; }
+inline F4 operator-(F4 a, F4 b) { return { vsubq_f32(a.v, b.v) }; }
+inline F4 operator*(F4 a, F4 b) { return { vmulq_f32(a.v, b.v) }; }
+
+template<int i>
+inline F4 splat(F4 a) { return { vdupq_laneq_f32(a.v, i) }; }
+
+inline void transpose(F4& a, F4& b, F4& c, F4& d) {
+    float32x4x2_t ab = vtrnq_f32(a.v, b.v);
+    float32x4x2_t cd = vtrnq_f32(c.v, d.v);
+    a.v = vcombine_f32(vget_low_f32(ab.val[0]),  vget_low_f32(cd.val[0]));
+    b.v = vcombine_f32(vget_low_f32(ab.val[1]),  vget_low_f32(cd.val[1]));
+    c.v = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+    d.v = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+#endif
+
+// 8 wide lanes, AVX only. Used by the batch kernels.
+#if defined(MATH_SIMD_AVX)
+struct F8 {
+    __m256 v;
+
+    static F8 load(const float* p) { return { _mm256_loadu_ps(p) }; }
+    static F8 set1(float f)        { return { _mm256_set1_ps(f) }; }
+    F4 lo() const                  { return { _mm256_castps256_ps128(v) }; }
+    F4 hi() const                  { return { _mm256_extractf128_ps(v, 1) }; }
+};
+
+inline F8 operator+(F8 a, F8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+inline F8 operator-(F8 a, F8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+inline F8 operator*(F8 a, F8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+#endif
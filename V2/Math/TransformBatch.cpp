@@ -0,0 +1,127 @@
+#include "TransformBatch.hpp"
+
+void TransformSoA::resize(size_t n) {
+    tx.resize(n, 0.0f); ty.resize(n, 0.0f); tz.resize(n, 0.0f);
+    qx.resize(n, 0.0f); qy.resize(n, 0.0f); qz.resize(n, 0.0f); qw.resize(n, 1.0f);
+    sx.resize(n, 1.0f); sy.resize(n, 1.0f); sz.resize(n, 1.0f);
+}
+
+void TransformSoA::set(size_t i, const Vec3& t, const Quat& r, const Vec3& s) {
+    tx[i] = t.x; ty[i] = t.y; tz[i] = t.z;
+    qx[i] = r.x; qy[i] = r.y; qz[i] = r.z; qw[i] = r.w;
+    sx[i] = s.x; sy[i] = s.y; sz[i] = s.z;
+}
+
+void TransformSoA::push(const Vec3& t, const Quat& r, const Vec3& s) {
+    resize(size() + 1);
+    set(size() - 1, t, r, s);
+}
+
+void composeTRSScalar(const TransformSoA& in, size_t first, size_t count, Mat4* out) {
+    for (size_t i = first; i < first + count; i++) {
+        out[i - first] = Mat4::fromTRS(
+            { in.tx[i], in.ty[i], in.tz[i] },
+            { in.qx[i], in.qy[i], in.qz[i], in.qw[i] },
+            { in.sx[i], in.sy[i], in.sz[i] });
+    }
+}
+
+#if defined(MATH_SIMD)
+namespace {
+
+// Same math as Mat4::fromTRS, but every value holds one object per lane.
+// L is F4 or F8. Produces the 12 non-constant matrix entries.
+template<typename L>
+struct TRSLanes {
+    L c0x, c0y, c0z;
+    L c1x, c1y, c1z;
+    L c2x, c2y, c2z;
+    L tx, ty, tz;
+
+    TRSLanes(const TransformSoA& in, size_t i) {
+        L x = L::load(&in.qx[i]), y = L::load(&in.qy[i]), z = L::load(&in.qz[i]), w = L::load(&in.qw[i]);
+        L sx = L::load(&in.sx[i]), sy = L::load(&in.sy[i]), sz = L::load(&in.sz[i]);
+        L one = L::set1(1.0f), two = L::set1(2.0f);
+
+        L xx = x * x, yy = y * y, zz = z * z;
+        L xy = x * y, xz = x * z, yz = y * z;
+        L wx = w * x, wy = w * y, wz = w * z;
+
+        c0x = (one - two * (yy + zz)) * sx;
+        c0y = two * (xy + wz) * sx;
+        c0z = two * (xz - wy) * sx;
+        c1x = two * (xy - wz) * sy;
+        c1y = (one - two * (xx + zz)) * sy;
+        c1z = two * (yz + wx) * sy;
+        c2x = two * (xz + wy) * sz;
+        c2y = two * (yz - wx) * sz;
+        c2z = (one - two * (xx + yy)) * sz;
+
+        tx = L::load(&in.tx[i]);
+        ty = L::load(&in.ty[i]);
+        tz = L::load(&in.tz[i]);
+    }
+};
+
+// Takes one matrix column for 4 objects (x, y, z and w in separate registers),
+// transposes it and stores it into those 4 matrices.
+inline void storeColumn4(F4 x, F4 y, F4 z, F4 w, Mat4* out, int col) {
+    transpose(x, y, z, w);
+    x.storeA(out[0].m + col * 4);
+    y.storeA(out[1].m + col * 4);
+    z.storeA(out[2].m + col * 4);
+    w.storeA(out[3].m + col * 4);
+}
+
+inline void store4(const F4& c0x, const F4& c0y, const F4& c0z,
+                   const F4& c1x, const F4& c1y, const F4& c1z,
+                   const F4& c2x, const F4& c2y, const F4& c2z,
+                   const F4& tx, const F4& ty, const F4& tz, Mat4* out) {
+    F4 zero = F4::set1(0.0f), one = F4::set1(1.0f);
+    storeColumn4(c0x, c0y, c0z, zero, out, 0);
+    storeColumn4(c1x, c1y, c1z, zero, out, 1);
+    storeColumn4(c2x, c2y, c2z, zero, out, 2);
+    storeColumn4(tx, ty, tz, one, out, 3);
+}
+
+} // namespace
+#endif
+
+void composeTRSSimd(const TransformSoA& in, size_t first, size_t count, Mat4* out) {
+    size_t i = first;
+    size_t end = first + count;
+
+#if defined(MATH_SIMD_AVX)
+    for (; i + 8 <= end; i += 8) {
+        TRSLanes<F8> t(in, i);
+        Mat4* dst = out + (i - first);
+        store4(t.c0x.lo(), t.c0y.lo(), t.c0z.lo(), t.c1x.lo(), t.c1y.lo(), t.c1z.lo(),
+               t.c2x.lo(), t.c2y.lo(), t.c2z.lo(), t.tx.lo(), t.ty.lo(), t.tz.lo(), dst);
+        store4(t.c0x.hi(), t.c0y.hi(), t.c0z.hi(), t.c1x.hi(), t.c1y.hi(), t.c1z.hi(),
+               t.c2x.hi(), t.c2y.hi(), t.c2z.hi(), t.tx.hi(), t.ty.hi(), t.tz.hi(), dst + 4);
+    }
+#endif
+
+#if defined(MATH_SIMD)
+    for (; i + 4 <= end; i += 4) {
+        TRSLanes<F4> t(in, i);
+        store4(t.c0x, t.c0y, t.c0z, t.c1x, t.c1y, t.c1z,
+               t.c2x, t.c2y, t.c2z, t.tx, t.ty, t.tz, out + (i - first));
+    }
+#endif
+
+    // leftovers (and everything when there is no SIMD)
+    composeTRSScalar(in, i, end - i, out + (i - first));
+}
+
+const char* simdPathName() {
+#if defined(MATH_SIMD_AVX)
+    return "avx";
+#elif defined(MATH_SIMD_SSE)
+    return "sse";
+#elif defined(MATH_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "Math/Math.hpp"
+
+// TRS records stored as structure of arrays so the batch kernels can load
+// 4 / 8 objects per register.
+struct TransformSoA {
+    std::vector<float> tx, ty, tz;
+    std::vector<float> qx, qy, qz, qw;
+    std::vector<float> sx, sy, sz;
+
+    size_t size() const { return tx.size(); }
+    void resize(size_t n);
+    void set(size_t i, const Vec3& t, const Quat& r, const Vec3& s);
+    void push(const Vec3& t, const Quat& r, const Vec3& s);
+};
+
+// Writes count column-major matrices (16 floats each) into out.
+// out is laid out exactly like a GL instance / uniform buffer of mat4s.
+void composeTRSScalar(const TransformSoA& in, size_t first, size_t count, Mat4* out);
+void composeTRSSimd(const TransformSoA& in, size_t first, size_t count, Mat4* out);
+
+inline void composeTRS(const TransformSoA& in, Mat4* out) {
+    composeTRSSimd(in, 0, in.size(), out);
+}
+
+// Which kernel composeTRSSimd ends up using. Handy for benchmark output.
+const char* simdPathName();
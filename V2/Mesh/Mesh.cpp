@@ -1,14 +1,50 @@
 #include "Mesh.hpp"
 
+#include <algorithm>
+
+#include "Debug/Profiler.hpp"
+#include "Debug/GLCapture.hpp"
+
 Mesh::Mesh(const float* vertices, size_t count, const VertexLayout& layout)
     : vbo(vertices, count * sizeof(float)),
     vertexCount(count / (layout.getStride() / sizeof(float)))
 {
     vao.addBuffer(vbo, layout);
+    computeBounds(vertices, layout);
 }
 
+void Mesh::computeBounds(const float* vertices, const VertexLayout& layout) {
+    const auto& attributes = layout.getAttributes();
+    if (attributes.empty() || attributes[0].type != GL_FLOAT || vertexCount == 0) {
+        return;
+    }
+
+    size_t strideFloats = layout.getStride() / sizeof(float);
+    size_t offset = attributes[0].offset / sizeof(float);
+    GLuint components = std::min<GLuint>(attributes[0].count, 3);
+
+    auto position = [&](size_t i) {
+        const float* p = vertices + i * strideFloats + offset;
+        return Vec3(p[0], components > 1 ? p[1] : 0.0f, components > 2 ? p[2] : 0.0f);
+    };
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        bounds.expand(position(i));
+    }
+
+    // centered on the box, radius reaches the farthest vertex
+    sphere.center = bounds.center();
+    float radiusSq = 0.0f;
+    for (size_t i = 0; i < vertexCount; i++) {
+        Vec3 d = position(i) - sphere.center;
+        radiusSq = std::max(radiusSq, dot(d, d));
+    }
+    sphere.radius = std::sqrt(radiusSq);
+}
 
 void Mesh::draw() const {
+    PROFILE_SCOPE("Mesh::draw");
     vao.bind();
     glDrawArrays(GL_TRIANGLES, 0,  vertexCount);
+    GLCapture::drawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertexCount));
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "Renderer/VertexArray.hpp"
 #include "Renderer/VertexLayout.hpp"
 #include "Renderer/VertexBuffer.hpp"
+#include "Math/Bounds.hpp"
 
 class Mesh {
 public:
@@ -14,8 +15,17 @@ public:
     ~Mesh() = default;
 
     void draw() const;
+
+    // Local space bounds, taken from the first (position) attribute
+    const AABB& getBounds() const { return bounds; }
+    const BoundingSphere& getBoundingSphere() const { return sphere; }
 private:
+    void computeBounds(const float* vertices, const VertexLayout& layout);
+
     VertexArray vao;
     VertexBuffer vbo;
     size_t vertexCount = 0;
+
+    AABB bounds;
+    BoundingSphere sphere;
 };
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "DepthPrepass.hpp"
+
+DepthPrepass::DepthPrepass(const char* depthVertexPath, const char* depthFragmentPath, const char* overdrawFragmentPath)
+    : depthOnly(depthVertexPath, depthFragmentPath),
+    overdraw(depthVertexPath, overdrawFragmentPath)
+{
+    glGenQueries(kQueryCount, queries);
+}
+
+DepthPrepass::~DepthPrepass() {
+    glDeleteQueries(kQueryCount, queries);
+}
+
+void DepthPrepass::beginDepthPass() {
+    if (!enabled) return;
+
+    depthOnly.use();
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+}
+
+void DepthPrepass::endDepthPass() {
+    if (!enabled) return;
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+void DepthPrepass::collectResults() {
+    // oldest first, stop at the first one that is not done yet
+    for (int i = 1; i <= kQueryCount; i++) {
+        int slot = (current + i) % kQueryCount;
+        if (!pending[slot]) continue;
+
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 samples = 0;
+        glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &samples);
+        lastFragments = samples;
+        pending[slot] = false;
+    }
+}
+
+void DepthPrepass::beginShadingPass() {
+    collectResults();
+
+    if (enabled) {
+        // depth is already final, only the front-most fragment survives
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+    }
+    if (showOverdraw) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+        overdraw.use();
+    }
+
+    current = (current + 1) % kQueryCount;
+    queryActive = !pending[current];
+    if (queryActive) {
+        glBeginQuery(GL_SAMPLES_PASSED, queries[current]);
+    }
+}
+
+void DepthPrepass::endShadingPass() {
+    if (queryActive) {
+        glEndQuery(GL_SAMPLES_PASSED);
+        pending[current] = true;
+        queryActive = false;
+    }
+
+    if (showOverdraw) {
+        glDisable(GL_BLEND);
+    }
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+
+#include "Shader/Shader.hpp"
+
+// Optional depth pre-pass.
+//
+//   beginDepthPass()   opaque meshes with depthShader(), color writes off
+//   endDepthPass()
+//   beginShadingPass() GL_EQUAL against the pre-pass depth, so each pixel is shaded once
+//   endShadingPass()
+//
+// The shading pass is wrapped in a GL_SAMPLES_PASSED query, i.e. the number of fragments
+// that passed the depth test and got shaded. It is read back a few frames late, never waited on.
+// showOverdraw swaps in an additive shader (overdrawShader()) that turns overdraw into brightness.
+class DepthPrepass {
+public:
+    DepthPrepass(const char* depthVertexPath, const char* depthFragmentPath, const char* overdrawFragmentPath);
+    ~DepthPrepass();
+
+    DepthPrepass(const DepthPrepass&) = delete;
+    DepthPrepass& operator=(const DepthPrepass&) = delete;
+
+    bool enabled = true;
+    bool showOverdraw = false;
+
+    void beginDepthPass();
+    void endDepthPass();
+
+    void beginShadingPass();
+    void endShadingPass();
+
+    const Shader& depthShader() const { return depthOnly; }
+    const Shader& overdrawShader() const { return overdraw; }
+
+    // Latest count the GPU has finished, 0 until the first one comes back
+    uint64_t fragmentsShaded() const { return lastFragments; }
+private:
+    static constexpr int kQueryCount = 4;
+
+    void collectResults();
+
+    Shader depthOnly;
+    Shader overdraw;
+
+    GLuint queries[kQueryCount] = {};
+    bool pending[kQueryCount] = {};
+    int current = 0;
+    bool queryActive = false;
+    uint64_t lastFragments = 0;
+};
@@ -0,0 +1,52 @@
+#include "GpuTimer.hpp"
+
+GpuTimer::GpuTimer() {
+    glGenQueries(kQueryCount, queries);
+}
+
+GpuTimer::~GpuTimer() {
+    glDeleteQueries(kQueryCount, queries);
+}
+
+void GpuTimer::collectResults() {
+    // oldest first, stop at the first one that is not done yet
+    for (int i = 1; i <= kQueryCount; i++) {
+        int slot = (current + i) % kQueryCount;
+        if (!pending[slot]) continue;
+
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &ns);
+        latestMs = ns / 1.0e6;
+        finishedMs += latestMs;
+        pending[slot] = false;
+    }
+}
+
+void GpuTimer::begin() {
+    collectResults();
+
+    current = (current + 1) % kQueryCount;
+    active = !pending[current]; // all slots still busy, skip this one
+    if (active) {
+        glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+    }
+}
+
+void GpuTimer::end() {
+    if (!active) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    pending[current] = true;
+    active = false;
+}
+
+double GpuTimer::takeFinishedMs() {
+    collectResults();
+    double ms = finishedMs;
+    finishedMs = 0.0;
+    return ms;
+}
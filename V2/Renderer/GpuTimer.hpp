@@ -0,0 +1,33 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// GL_TIME_ELAPSED around a span of GL commands (usually a whole frame).
+// Results come back a few frames late and are only read once available, so it never stalls.
+class GpuTimer {
+public:
+    GpuTimer();
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void begin();
+    void end();
+
+    // Milliseconds of every result that came back since the last call
+    double takeFinishedMs();
+    // Most recent single result
+    double lastMs() const { return latestMs; }
+private:
+    static constexpr int kQueryCount = 4;
+
+    void collectResults();
+
+    GLuint queries[kQueryCount] = {};
+    bool pending[kQueryCount] = {};
+    int current = 0;
+    bool active = false;
+    double finishedMs = 0.0;
+    double latestMs = 0.0;
+};
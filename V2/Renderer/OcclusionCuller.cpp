@@ -0,0 +1,168 @@
+#include "OcclusionCuller.hpp"
+
+#include "Debug/GLCapture.hpp"
+
+namespace {
+
+// unit cube, 12 triangles, wound counter clockwise from the outside
+const float kCube[] = {
+    -1,-1, 1,   1,-1, 1,   1, 1, 1,   -1,-1, 1,   1, 1, 1,  -1, 1, 1,
+     1,-1,-1,  -1,-1,-1,  -1, 1,-1,    1,-1,-1,  -1, 1,-1,   1, 1,-1,
+    -1,-1,-1,  -1,-1, 1,  -1, 1, 1,   -1,-1,-1,  -1, 1, 1,  -1, 1,-1,
+     1,-1, 1,   1,-1,-1,   1, 1,-1,    1,-1, 1,   1, 1,-1,   1, 1, 1,
+    -1, 1, 1,   1, 1, 1,   1, 1,-1,   -1, 1, 1,   1, 1,-1,  -1, 1,-1,
+    -1,-1,-1,   1,-1,-1,   1,-1, 1,   -1,-1,-1,   1,-1, 1,  -1,-1, 1,
+};
+
+VertexLayout cubeLayout() {
+    VertexLayout layout;
+    layout.push<float>(3);
+    return layout;
+}
+
+} // namespace
+
+OcclusionCuller::OcclusionCuller(const char* proxyVertexPath, const char* proxyFragmentPath,
+                                 unsigned queriesPerObject, size_t maxQueriesInFlight)
+    : queriesPerObject(queriesPerObject),
+    maxQueriesInFlight(maxQueriesInFlight),
+    proxyShader(proxyVertexPath, proxyFragmentPath),
+    cubeVbo(kCube, sizeof(kCube)),
+    viewProj(Mat4::identity())
+{
+    cubeVao.addBuffer(cubeVbo, cubeLayout());
+}
+
+OcclusionCuller::~OcclusionCuller() {
+    for (const Slot& s : slots) {
+        glDeleteQueries(1, &s.query);
+    }
+}
+
+uint32_t OcclusionCuller::addObject() {
+    Object o;
+    o.firstSlot = static_cast<uint32_t>(slots.size());
+
+    std::vector<GLuint> ids(queriesPerObject);
+    glGenQueries(queriesPerObject, ids.data());
+    for (GLuint id : ids) {
+        Slot s;
+        s.query = id;
+        slots.push_back(s);
+    }
+
+    objects.push_back(o);
+    return static_cast<uint32_t>(objects.size() - 1);
+}
+
+void OcclusionCuller::beginFrame() {
+    frame++;
+    frameStats = OcclusionStats{};
+
+    // only look at results the driver already has, a busy query just stays pending
+    auto now = Clock::now();
+    for (Object& o : objects) {
+        o.activeQuery = 0;
+
+        // oldest first so lastVisible ends up with the newest available result
+        for (unsigned i = 0; i < queriesPerObject; i++) {
+            Slot& s = slots[o.firstSlot + (o.nextSlot + i) % queriesPerObject];
+            if (!s.pending) continue;
+
+            GLuint available = 0;
+            glGetQueryObjectuiv(s.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+
+            GLuint samplesPassed = 0;
+            glGetQueryObjectuiv(s.query, GL_QUERY_RESULT, &samplesPassed);
+            o.lastVisible = samplesPassed != 0;
+            s.pending = false;
+            inFlight--;
+
+            latencyFramesSum += static_cast<double>(frame - s.frame);
+            latencyMsSum += std::chrono::duration<double, std::milli>(now - s.issued).count();
+            latencySamples++;
+        }
+    }
+
+    if (latencySamples) {
+        frameStats.avgLatencyFrames = latencyFramesSum / latencySamples;
+        frameStats.avgLatencyMs = latencyMsSum / latencySamples;
+    }
+    frameStats.queriesInFlight = inFlight;
+}
+
+void OcclusionCuller::beginQueries(const Mat4& viewProjection, const Vec3& eyePosition) {
+    viewProj = viewProjection;
+    eye = eyePosition;
+
+    proxyShader.use();
+    cubeVao.bind();
+
+    // proxies only test against the depth buffer, they must not change anything
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+}
+
+void OcclusionCuller::issueQuery(uint32_t id, const AABB& worldBounds) {
+    Object& o = objects[id];
+
+    // a camera inside the box would only see back faces and call it occluded
+    AABB grown = worldBounds;
+    grown.min = grown.min - Vec3(0.05f, 0.05f, 0.05f);
+    grown.max = grown.max + Vec3(0.05f, 0.05f, 0.05f);
+    if (eye.x >= grown.min.x && eye.x <= grown.max.x &&
+        eye.y >= grown.min.y && eye.y <= grown.max.y &&
+        eye.z >= grown.min.z && eye.z <= grown.max.z) {
+        o.lastVisible = true;
+        return;
+    }
+
+    Slot& s = slots[o.firstSlot + o.nextSlot];
+    if (s.pending || inFlight >= maxQueriesInFlight) {
+        // never reuse a query the GPU has not answered yet, that would block
+        frameStats.queriesSkipped++;
+        return;
+    }
+
+    Mat4 model = Mat4::translation(grown.center()) * Mat4::scale(grown.extents());
+    Mat4 mvp = viewProj * model;
+    proxyShader.setMat4("uMVP", mvp.data());
+
+    glBeginQuery(GL_ANY_SAMPLES_PASSED, s.query);
+    glDrawArrays(GL_TRIANGLES, 0, 36);
+    GLCapture::drawArrays(GL_TRIANGLES, 0, 36);
+    glEndQuery(GL_ANY_SAMPLES_PASSED);
+
+    s.pending = true;
+    s.frame = frame;
+    s.issued = Clock::now();
+    o.activeQuery = s.query;
+    o.nextSlot = (o.nextSlot + 1) % queriesPerObject;
+
+    inFlight++;
+    frameStats.queriesIssued++;
+    frameStats.queriesInFlight = inFlight;
+}
+
+void OcclusionCuller::endQueries() {
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+    cubeVao.unbind();
+}
+
+void OcclusionCuller::beginConditional(uint32_t id) {
+    const Object& o = objects[id];
+    if (!o.lastVisible) {
+        frameStats.occludedDraws++;
+    }
+    if (o.activeQuery) {
+        glBeginConditionalRender(o.activeQuery, conditionMode);
+    }
+}
+
+void OcclusionCuller::endConditional(uint32_t id) {
+    if (objects[id].activeQuery) {
+        glEndConditionalRender();
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "Renderer/VertexArray.hpp"
+#include "Renderer/VertexBuffer.hpp"
+#include "Shader/Shader.hpp"
+#include "Math/Bounds.hpp"
+
+struct OcclusionStats {
+    size_t queriesIssued = 0;      // this frame
+    size_t queriesSkipped = 0;     // slot still busy, object drawn unconditionally
+    size_t queriesInFlight = 0;
+    size_t occludedDraws = 0;      // draws whose latest readback said 0 samples passed
+    double avgLatencyFrames = 0.0; // issue -> result available, seen from the CPU
+    double avgLatencyMs = 0.0;
+};
+
+// Hardware occlusion queries on proxy boxes.
+//
+// Per frame:
+//   beginFrame()                     picks up finished queries, never waits
+//   draw the big occluders
+//   beginQueries(viewProj, eye)
+//     issueQuery(id, worldBounds)    one GL_ANY_SAMPLES_PASSED query per object
+//   endQueries()
+//   beginConditional(id) / draw / endConditional(id)
+//
+// The draw is wrapped in glBeginConditionalRender, so the GPU drops it when the proxy
+// was hidden. The CPU only ever reads results that are already available (a frame or
+// more late) and uses them for the stats.
+class OcclusionCuller {
+public:
+    OcclusionCuller(const char* proxyVertexPath, const char* proxyFragmentPath,
+                    unsigned queriesPerObject = 3, size_t maxQueriesInFlight = 4096);
+    ~OcclusionCuller();
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    uint32_t addObject();
+
+    void beginFrame();
+
+    void beginQueries(const Mat4& viewProj, const Vec3& eye);
+    void issueQuery(uint32_t id, const AABB& worldBounds);
+    void endQueries();
+
+    void beginConditional(uint32_t id);
+    void endConditional(uint32_t id);
+
+    // Last result the CPU has seen, true until a query says otherwise
+    bool wasVisible(uint32_t id) const { return objects[id].lastVisible; }
+
+    // GL_QUERY_WAIT lets the GPU wait for its own query (no CPU stall),
+    // GL_QUERY_NO_WAIT draws anyway when the result is not ready yet
+    GLenum conditionMode = GL_QUERY_WAIT;
+
+    const OcclusionStats& stats() const { return frameStats; }
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Slot {
+        GLuint query = 0;
+        bool pending = false;
+        uint64_t frame = 0;
+        Clock::time_point issued;
+    };
+
+    struct Object {
+        uint32_t firstSlot = 0;
+        uint32_t nextSlot = 0;
+        GLuint activeQuery = 0; // issued this frame, used for the conditional draw
+        bool lastVisible = true;
+    };
+
+    unsigned queriesPerObject;
+    size_t maxQueriesInFlight;
+
+    Shader proxyShader;
+    VertexBuffer cubeVbo;
+    VertexArray cubeVao;
+
+    std::vector<Slot> slots;
+    std::vector<Object> objects;
+
+    Mat4 viewProj;
+    Vec3 eye;
+    uint64_t frame = 0;
+    size_t inFlight = 0;
+
+    OcclusionStats frameStats;
+    double latencyFramesSum = 0.0;
+    double latencyMsSum = 0.0;
+    size_t latencySamples = 0;
+};
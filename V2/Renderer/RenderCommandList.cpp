@@ -0,0 +1,92 @@
+#include "RenderCommandList.hpp"
+
+#include "Shader/Shader.hpp"
+#include "Mesh/Mesh.hpp"
+#include "Renderer/Texture.hpp"
+#include "Debug/GLCapture.hpp"
+
+void RenderCommandList::push(Op op, const void* object, const char* name, int32_t value, uint32_t data) {
+    commands.push_back({ op, value, data, object, name });
+}
+
+void RenderCommandList::clear(GLbitfield mask, float r, float g, float b, float a) {
+    uint32_t offset = static_cast<uint32_t>(floats.size());
+    floats.insert(floats.end(), { r, g, b, a });
+    push(Op::Clear, nullptr, nullptr, static_cast<int32_t>(mask), offset);
+}
+
+void RenderCommandList::useProgram(const Shader& shader) {
+    push(Op::UseProgram, &shader, nullptr, 0, 0);
+}
+
+void RenderCommandList::setMat4(const Shader& shader, const char* name, const float* m) {
+    uint32_t offset = static_cast<uint32_t>(floats.size());
+    floats.insert(floats.end(), m, m + 16);
+    push(Op::SetMat4, &shader, name, 0, offset);
+}
+
+void RenderCommandList::setInt(const Shader& shader, const char* name, int value) {
+    push(Op::SetInt, &shader, name, value, 0);
+}
+
+void RenderCommandList::setFloat(const Shader& shader, const char* name, float value) {
+    uint32_t offset = static_cast<uint32_t>(floats.size());
+    floats.push_back(value);
+    push(Op::SetFloat, &shader, name, 0, offset);
+}
+
+void RenderCommandList::bindTexture(const Texture& texture, unsigned slot) {
+    push(Op::BindTexture, &texture, nullptr, static_cast<int32_t>(slot), 0);
+}
+
+void RenderCommandList::draw(const Mesh& mesh) {
+    push(Op::Draw, &mesh, nullptr, 0, 0);
+}
+
+void RenderCommandList::call(std::function<void()> fn) {
+    push(Op::Call, nullptr, nullptr, static_cast<int32_t>(callbacks.size()), 0);
+    callbacks.push_back(std::move(fn));
+}
+
+void RenderCommandList::execute() const {
+    for (const Command& c : commands) {
+        switch (c.op) {
+        case Op::Clear: {
+            const float* color = &floats[c.data];
+            GLbitfield mask = static_cast<GLbitfield>(c.value);
+            glClearColor(color[0], color[1], color[2], color[3]);
+            glClear(mask);
+            GLCapture::clear(mask);
+            break;
+        }
+        case Op::UseProgram:
+            static_cast<const Shader*>(c.object)->use();
+            break;
+        case Op::SetMat4:
+            static_cast<const Shader*>(c.object)->setMat4(c.name, &floats[c.data]);
+            break;
+        case Op::SetInt:
+            static_cast<const Shader*>(c.object)->setInt(c.name, c.value);
+            break;
+        case Op::SetFloat:
+            static_cast<const Shader*>(c.object)->setFloat(c.name, floats[c.data]);
+            break;
+        case Op::BindTexture:
+            static_cast<const Texture*>(c.object)->bind(static_cast<unsigned>(c.value));
+            break;
+        case Op::Draw:
+            static_cast<const Mesh*>(c.object)->draw();
+            break;
+        case Op::Call:
+            callbacks[c.value]();
+            break;
+        }
+    }
+}
+
+void RenderCommandList::reset() {
+    commands.clear();
+    floats.clear();
+    callbacks.clear();
+    present = true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class Shader;
+class Texture;
+class Mesh;
+
+// One frame worth of render commands, recorded on the main thread and executed on
+// whichever thread owns the GL context (see RenderThread).
+//
+// Commands are small PODs, uniform data goes into a side array, so recording never
+// touches GL and a reused list doesn't allocate once it has seen its biggest frame.
+// call() is the escape hatch for systems that do their own GL work (queries, passes);
+// whatever the closure touches belongs to the render thread from then on.
+//
+// Objects and uniform names are referenced, not copied: they have to live until the
+// list has executed (names should be string literals).
+class RenderCommandList {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void clear(GLbitfield mask, float r, float g, float b, float a);
+    void useProgram(const Shader& shader);
+    void setMat4(const Shader& shader, const char* name, const float* m);
+    void setInt(const Shader& shader, const char* name, int value);
+    void setFloat(const Shader& shader, const char* name, float value);
+    void bindTexture(const Texture& texture, unsigned slot);
+    void draw(const Mesh& mesh);
+    void call(std::function<void()> fn);
+
+    // Runs everything in order on the calling thread, which must have the context current
+    void execute() const;
+    void reset();
+
+    size_t size() const { return commands.size(); }
+
+    // When the input this frame reacts to was read, for input-to-present latency
+    Clock::time_point inputTime;
+    bool present = true; // swap after executing
+private:
+    enum class Op : uint8_t {
+        Clear,
+        UseProgram,
+        SetMat4,
+        SetInt,
+        SetFloat,
+        BindTexture,
+        Draw,
+        Call
+    };
+
+    struct Command {
+        Op op;
+        int32_t value;      // clear mask, int uniform, texture slot, callback index
+        uint32_t data;      // offset into floats
+        const void* object; // Shader / Texture / Mesh
+        const char* name;   // uniform name
+    };
+
+    void push(Op op, const void* object, const char* name, int32_t value, uint32_t data);
+
+    std::vector<Command> commands;
+    std::vector<float> floats;
+    std::vector<std::function<void()>> callbacks;
+};
@@ -0,0 +1,135 @@
+#include "RenderThread.hpp"
+
+#include "Window/Window.hpp"
+
+namespace {
+    double millisSince(FrameClock::Clock::time_point start, FrameClock::Clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+}
+
+RenderThread::RenderThread(Window& window, bool threaded)
+    : window(window), threaded(threaded)
+{
+    for (RenderCommandList& list : lists) {
+        returned.push(&list);
+    }
+    if (threaded) {
+        // a context can only be current on one thread at a time
+        window.releaseCurrent();
+        thread = std::thread([this] { renderLoop(); });
+        running = true;
+    }
+}
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+RenderCommandList& RenderThread::beginFrame() {
+    FrameClock::Clock::time_point start = FrameClock::Clock::now();
+
+    RenderCommandList* list = nullptr;
+    if (!returned.pop(list)) {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        listFree.wait(lock, [this] { return !returned.empty(); });
+        returned.pop(list);
+    }
+    FrameClock::Clock::time_point now = FrameClock::Clock::now();
+    mainWaitTimes.add(millisSince(start, now));
+
+    list->reset();
+    list->inputTime = now; // callers that know better overwrite it
+    return *list;
+}
+
+void RenderThread::submit(RenderCommandList& list) {
+    FrameClock::Clock::time_point inputTime = list.inputTime; // the list isn't ours once it's pushed
+    if (!threaded) {
+        run(list);
+        returned.push(&list);
+    } else {
+        submitted.push(&list); // never full, there are only kListCount lists
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+        }
+        workReady.notify_one();
+    }
+    mainFrameTimes.add(millisSince(inputTime, FrameClock::Clock::now()));
+}
+
+void RenderThread::stop() {
+    if (!running) return;
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    workReady.notify_one();
+    thread.join();
+    running = false;
+    window.makeCurrent();
+}
+
+void RenderThread::renderLoop() {
+    window.makeCurrent();
+    for (;;) {
+        RenderCommandList* list = nullptr;
+        if (!submitted.pop(list)) {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            workReady.wait(lock, [this] { return !submitted.empty() || stopping.load(); });
+            if (!submitted.pop(list)) {
+                break; // stopping, and everything queued has run
+            }
+        }
+
+        run(*list);
+
+        returned.push(list);
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+        }
+        listFree.notify_one();
+    }
+    window.releaseCurrent();
+}
+
+void RenderThread::run(RenderCommandList& list) {
+    FrameClock::Clock::time_point start = FrameClock::Clock::now();
+    list.execute();
+    if (list.present) {
+        window.swapBuffers();
+    }
+    FrameClock::Clock::time_point end = FrameClock::Clock::now();
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    renderTimes.add(millisSince(start, end));
+    if (list.present) {
+        inputLatency.add(millisSince(list.inputTime, end));
+        presentTimes.push_back(end);
+    }
+}
+
+std::vector<FrameClock::Clock::time_point> RenderThread::takePresentTimes() {
+    std::vector<FrameClock::Clock::time_point> times;
+    std::lock_guard<std::mutex> lock(statsMutex);
+    times.swap(presentTimes);
+    return times;
+}
+
+void RenderThread::printStats(std::ostream& out) {
+    out << (threaded ? "render thread:\n" : "single threaded:\n");
+    mainFrameTimes.print(out, "main thread frame");
+    mainWaitTimes.print(out, "main thread waiting");
+    std::lock_guard<std::mutex> lock(statsMutex);
+    renderTimes.print(out, "execute + swap");
+    inputLatency.print(out, "input to present");
+}
+
+void RenderThread::resetStats() {
+    mainFrameTimes.clear();
+    mainWaitTimes.clear();
+    std::lock_guard<std::mutex> lock(statsMutex);
+    renderTimes.clear();
+    inputLatency.clear();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include "Core/FrameClock.hpp"
+#include "Core/SpscQueue.hpp"
+#include "Renderer/RenderCommandList.hpp"
+
+class Window;
+
+// Owns the GL context on a thread of its own, so a slow swap or driver call no longer
+// holds up event handling and simulation on the main thread.
+//
+//   RenderCommandList& cmd = renderer.beginFrame(); // main thread
+//   cmd.draw(mesh); ...
+//   renderer.submit(cmd);                           // render thread executes + swaps
+//
+// kListCount lists go round between the threads through two SPSC rings: the main thread
+// records one while the render thread executes the other, and beginFrame() blocks when
+// the render thread is that far behind, which also caps the added latency at one frame.
+//
+// With threaded = false everything runs inline in submit() on the calling thread, which
+// gives the single threaded numbers to compare against.
+//
+// SDL events must still be pumped on the main thread; GL objects may be created there
+// only before the renderer starts or after stop().
+class RenderThread {
+public:
+    explicit RenderThread(Window& window, bool threaded = true);
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    RenderCommandList& beginFrame();
+    void submit(RenderCommandList& list);
+
+    // Executes what is queued, joins the thread and makes the context current on the caller again
+    void stop();
+
+    bool isThreaded() const { return threaded; }
+
+    // When the swaps since the last call returned, oldest first, for FrameClock::markPresent()
+    std::vector<FrameClock::Clock::time_point> takePresentTimes();
+
+    // Main thread: beginFrame() to submit() returning, including any wait for a free list.
+    // Render thread: execute + swap, and input to the swap returning.
+    void printStats(std::ostream& out);
+    void resetStats();
+private:
+    static constexpr int kListCount = 2;
+
+    void renderLoop();
+    void run(RenderCommandList& list);
+
+    Window& window;
+    bool threaded;
+    bool running = false;
+    std::thread thread;
+
+    RenderCommandList lists[kListCount];
+    SpscQueue<RenderCommandList*> submitted{ kListCount };
+    SpscQueue<RenderCommandList*> returned{ kListCount };
+
+    // the rings never block, these are only for sleeping when there is nothing to do
+    std::mutex wakeMutex;
+    std::condition_variable workReady;
+    std::condition_variable listFree;
+    std::atomic<bool> stopping{ false };
+
+    FrameTimeHistogram mainFrameTimes;
+    FrameTimeHistogram mainWaitTimes;
+
+    std::mutex statsMutex; // render side histograms are written there and printed here
+    FrameTimeHistogram renderTimes;
+    FrameTimeHistogram inputLatency;
+    std::vector<FrameClock::Clock::time_point> presentTimes;
+};
@@ -0,0 +1,201 @@
+#include "ResourceLoader.hpp"
+
+#include <iostream>
+
+#include "stb_image.h"
+
+#include "Window/Window.hpp"
+#include "Debug/GLCapture.hpp"
+
+namespace {
+    double millisSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+ResourceLoader::ResourceLoader(Window& window)
+    : window(window)
+{
+    if (GLCapture::active()) {
+        std::cout << "ResourceLoader: capturing, uploads stay on the render thread\n";
+    } else {
+        context = window.createSharedContext();
+    }
+    if (context) {
+        thread = std::thread([this] { loaderLoop(); });
+    }
+}
+
+ResourceLoader::~ResourceLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+    // nobody is going to poll these anymore
+    for (const Fenced& f : fenced) {
+        if (f.fence) glDeleteSync(f.fence);
+    }
+    for (const Fenced& f : waiting) {
+        if (f.fence) glDeleteSync(f.fence);
+    }
+    if (context) {
+        SDL_GL_DeleteContext(context);
+    }
+}
+
+void ResourceLoader::loaderLoop() {
+    SDL_GL_MakeCurrent(window.getSDLWindow(), context);
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping) break;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+    SDL_GL_MakeCurrent(window.getSDLWindow(), nullptr);
+}
+
+void ResourceLoader::enqueue(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+        outstanding++;
+    }
+    cv.notify_one();
+}
+
+template <typename T>
+void ResourceLoader::publish(const std::shared_ptr<Upload<T>>& upload, size_t size,
+                             Clock::time_point requested, Clock::time_point uploadStart) {
+    GLsync fence = nullptr;
+    if (context) {
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush(); // nothing else flushes this context, the fence would never signal
+    }
+    // the driver may still be copying after this, the fence tells when it's really done
+    double seconds = millisSince(uploadStart) / 1000.0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    bytes += size;
+    uploadSeconds += seconds;
+    fenced.push_back({ fence, requested, [upload] { upload->isReady = true; } });
+}
+
+TextureUpload ResourceLoader::loadTexture(const std::string& path) {
+    TextureUpload upload = std::make_shared<Upload<Texture>>();
+    Clock::time_point requested = Clock::now();
+    enqueue([this, upload, path, requested] {
+        stbi_set_flip_vertically_on_load(true);
+        int width = 0, height = 0, channels = 0;
+        unsigned char* rgba = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        if (!rgba) {
+            std::cerr << "ResourceLoader: could not load " << path << ": " << stbi_failure_reason() << "\n";
+            // no texture at all rather than a 0x0 one, it comes out of poll() as failed
+            std::lock_guard<std::mutex> lock(mutex);
+            fenced.push_back({ nullptr, requested, [upload] { upload->isFailed = true; } });
+            return;
+        }
+
+        Clock::time_point start = Clock::now();
+        upload->object = std::make_unique<Texture>(rgba, width, height, path);
+        publish(upload, static_cast<size_t>(width) * height * 4, requested, start);
+        stbi_image_free(rgba);
+    });
+    return upload;
+}
+
+BufferUpload ResourceLoader::uploadBuffer(std::vector<uint8_t> data) {
+    BufferUpload upload = std::make_shared<Upload<VertexBuffer>>();
+    Clock::time_point requested = Clock::now();
+    enqueue([this, upload, data = std::move(data), requested] {
+        Clock::time_point start = Clock::now();
+        upload->object = std::make_unique<VertexBuffer>(data.data(), data.size());
+        publish(upload, data.size(), requested, start);
+    });
+    return upload;
+}
+
+void ResourceLoader::poll() {
+    if (!context) {
+        // no loader thread, the jobs run here instead
+        std::deque<std::function<void()>> run;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            run.swap(jobs);
+        }
+        for (auto& job : run) {
+            job();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Fenced& f : fenced) {
+            waiting.push_back(std::move(f));
+        }
+        fenced.clear();
+    }
+
+    // one context's fences signal in order, so stop at the first one that is still pending
+    size_t done = 0;
+    double latency = 0.0;
+    for (; done < waiting.size(); done++) {
+        Fenced& f = waiting[done];
+        if (f.fence) {
+            GLenum status = glClientWaitSync(f.fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) break;
+            if (status == GL_WAIT_FAILED) {
+                std::cerr << "ResourceLoader: glClientWaitSync failed\n";
+            }
+            glDeleteSync(f.fence);
+        }
+        f.markReady();
+        latency += millisSince(f.requested);
+    }
+    waiting.erase(waiting.begin(), waiting.begin() + done);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    completed += done;
+    latencyMs += latency;
+    inFlight = waiting.size();
+    outstanding -= done;
+}
+
+bool ResourceLoader::hasPending() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return outstanding > 0;
+}
+
+LoaderStats ResourceLoader::takeStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    LoaderStats s;
+    s.queued = jobs.size();
+    s.inFlight = inFlight + fenced.size();
+    s.completed = completed;
+    s.bytes = bytes;
+    s.uploadMiBps = uploadSeconds > 0.0 ? bytes / (1024.0 * 1024.0) / uploadSeconds : 0.0;
+    s.avgLatencyMs = completed ? latencyMs / completed : 0.0;
+
+    completed = 0;
+    bytes = 0;
+    uploadSeconds = 0.0;
+    latencyMs = 0.0;
+    return s;
+}
+
+void ResourceLoader::printStats(std::ostream& out) {
+    LoaderStats s = takeStats();
+    out << "loader" << (isThreaded() ? "" : " (inline)") << ": " << s.queued << " queued, "
+        << s.inFlight << " in flight, " << s.completed << " done, "
+        << s.bytes / (1024.0 * 1024.0) << " MiB at " << s.uploadMiBps << " MiB/s, latency "
+        << s.avgLatencyMs << " ms\n";
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <SDL_2/SDL.h>
+#include <glad/glad.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Renderer/Texture.hpp"
+#include "Renderer/VertexBuffer.hpp"
+
+class Window;
+
+// A texture or buffer on its way through the ResourceLoader.
+// get() is nullptr until the GPU has finished the upload, and stays nullptr when it failed
+// (file missing or not decodable), so callers keep whatever they draw without it.
+// Only call these on the render thread.
+template <typename T>
+class Upload {
+public:
+    bool ready() const { return isReady; }
+    bool failed() const { return isFailed; }
+    const T* get() const { return isReady ? object.get() : nullptr; }
+private:
+    friend class ResourceLoader;
+
+    std::unique_ptr<T> object;
+    bool isReady = false;
+    bool isFailed = false;
+};
+
+using TextureUpload = std::shared_ptr<Upload<Texture>>;
+using BufferUpload = std::shared_ptr<Upload<VertexBuffer>>;
+
+struct LoaderStats {
+    size_t queued = 0;       // waiting for the loader thread
+    size_t inFlight = 0;     // uploaded, fence not signaled yet
+    uint64_t completed = 0;
+    uint64_t bytes = 0;      // uploaded since the last takeStats()
+    double uploadMiBps = 0.0;   // bytes over the time spent in the upload calls
+    double avgLatencyMs = 0.0;  // request to usable
+};
+
+// Decodes and uploads textures and vertex buffers on a thread with its own GL context,
+// shared with the window's, so glTexImage2D / glBufferData never run on the render thread.
+//
+// Each upload ends with a glFenceSync; poll() on the render thread checks the fences
+// without waiting and hands out whatever the GPU has finished. The objects are shared
+// between the contexts, VAOs are not, so meshes still get their VAO on the render thread.
+//
+// Construct it on the thread that has the window's context current (before RenderThread
+// takes it). Falls back to running the jobs inside poll() when there is no shared context,
+// or while GLCapture is recording (it is single threaded).
+class ResourceLoader {
+public:
+    explicit ResourceLoader(Window& window);
+    ~ResourceLoader();
+
+    ResourceLoader(const ResourceLoader&) = delete;
+    ResourceLoader& operator=(const ResourceLoader&) = delete;
+
+    // Any thread
+    TextureUpload loadTexture(const std::string& path);
+    BufferUpload uploadBuffer(std::vector<uint8_t> data);
+
+    // Render thread, once per frame
+    void poll();
+    // Any thread: something requested has not come out of poll() yet. Uploads only show up
+    // in frames, so the main loop has to keep rendering now and then while this is true.
+    bool hasPending();
+
+    bool isThreaded() const { return context != nullptr; }
+
+    LoaderStats takeStats();
+    void printStats(std::ostream& out);
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Fenced {
+        GLsync fence; // nullptr when the upload ran on the render thread
+        Clock::time_point requested;
+        std::function<void()> markReady;
+    };
+
+    void loaderLoop();
+    void enqueue(std::function<void()> job);
+    // loader side: fence the upload and hand it to poll()
+    template <typename T>
+    void publish(const std::shared_ptr<Upload<T>>& upload, size_t size,
+                 Clock::time_point requested, Clock::time_point uploadStart);
+
+    Window& window;
+    SDL_GLContext context = nullptr;
+    std::thread thread;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> jobs;
+    bool stopping = false;
+
+    std::vector<Fenced> fenced; // published, not yet seen by poll()
+    std::vector<Fenced> waiting; // render thread only, oldest first
+
+    // guarded by mutex
+    size_t outstanding = 0; // requested, not yet through poll()
+    size_t inFlight = 0;
+    uint64_t completed = 0;
+    uint64_t bytes = 0;
+    double uploadSeconds = 0.0;
+    double latencyMs = 0.0;
+};
@@ -7,20 +7,15 @@
 #include "Texture.hpp"
 #include <iostream>
 
+#include "Debug/Profiler.hpp"
+#include "Debug/DebugOutput.hpp"
+#include "Debug/GLCapture.hpp"
 
-Texture::Texture(const std::string& path) {
-	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_2D, textureID);
 
-	std::cout << "Texture id = " << textureID << "\n";
-
-	// sets texture parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	
+Texture::Texture(const std::string& path) {
 	stbi_set_flip_vertically_on_load(true);
 
-	int width, height, channels;
+	int channels = 0;
 	std::cout << "Loading texture: " << path << "\n";
 
 	unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
@@ -33,22 +28,46 @@ Texture::Texture(const std::string& path) {
 		std::cout << "SUCCESS: " << width << "x" << height << " channels=" << channels << "\n";
 	}
 
+	create(data, path);
+	std::cout << "Texture id = " << textureID << "\n";
 
-	glTexImage2D(
-		GL_TEXTURE_2D, 0, GL_RGBA,
-		width, height, 0,
-		GL_RGBA, GL_UNSIGNED_BYTE, data);
+	stbi_image_free(data);
+}
 
-	glGenerateMipmap(GL_TEXTURE_2D);
+Texture::Texture(const unsigned char* rgba, int width, int height, const std::string& label)
+	: width(width), height(height)
+{
+	create(rgba, label);
+}
 
-	stbi_image_free(data);
+void Texture::create(const unsigned char* rgba, const std::string& label) {
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	DebugOutput::label(GL_TEXTURE, textureID, label.c_str());
+
+	// sets texture parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	{
+		PROFILE_SCOPE("Texture::upload");
+		glTexImage2D(
+			GL_TEXTURE_2D, 0, GL_RGBA,
+			width, height, 0,
+			GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	GLCapture::createTexture(textureID, width, height, rgba);
 }
 
 Texture::~Texture() {
 	glDeleteTextures(1, &textureID);
+	GLCapture::deleteTexture(textureID);
 }
 
 void Texture::bind(unsigned int slot) const {
 	glActiveTexture(GL_TEXTURE0 + slot);
 	glBindTexture(GL_TEXTURE_2D, textureID);
+	GLCapture::bindTexture(slot, textureID);
 }
\ No newline at end of file
@@ -6,9 +6,18 @@
 class Texture {
 public:
 	Texture(const std::string& path);
+	// Already decoded RGBA8 (see ResourceLoader), label is only for debug output
+	Texture(const unsigned char* rgba, int width, int height, const std::string& label);
 	~Texture();
 
 	void bind(unsigned int slot) const;
+
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
 private:
+	void create(const unsigned char* rgba, const std::string& label);
+
 	GLuint textureID = 0;
+	int width = 0;
+	int height = 0;
 };
@@ -1,23 +1,39 @@
 #include "VertexArray.hpp"
 
+#include <cstdio>
+
+#include "Debug/DebugOutput.hpp"
+#include "Debug/GLCapture.hpp"
+
 VertexArray::VertexArray() {
     glGenVertexArrays(1, &vao);
+    GLCapture::createVertexArray(vao);
 }
 
 VertexArray::~VertexArray() {
     glDeleteVertexArrays(1, &vao);
+    GLCapture::deleteVertexArray(vao);
 }
 
 void VertexArray::bind() const {
     glBindVertexArray(vao);
+    GLCapture::bindVertexArray(vao);
 }
 
 void VertexArray::unbind() const {
     glBindVertexArray(0);
+    GLCapture::bindVertexArray(0);
 }
 
 void VertexArray::addBuffer(const VertexBuffer& vbo, const VertexLayout& layout) {
     bind();
+
+#if defined(V2_GL_DEBUG)
+    // a vao only exists once it has been bound, so it can't be labeled in the constructor
+    char name[32];
+    std::snprintf(name, sizeof(name), "VertexArray %u", vao);
+    DebugOutput::label(GL_VERTEX_ARRAY, vao, name);
+#endif
     vbo.bind();
 
     const auto& attributes = layout.getAttributes();
@@ -35,6 +51,7 @@ void VertexArray::addBuffer(const VertexBuffer& vbo, const VertexLayout& layout)
             stride,
             reinterpret_cast<const void*>(static_cast<uintptr_t>(attr.offset))
         );
+        GLCapture::vertexAttrib(vao, vbo.id(), i, attr.count, attr.type, attr.normalized, stride, attr.offset);
     }
 
     vbo.unbind();
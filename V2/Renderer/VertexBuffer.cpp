@@ -1,13 +1,26 @@
 #include "VertexBuffer.hpp"
 
+#include <cstdio>
+
+#include "Debug/DebugOutput.hpp"
+#include "Debug/GLCapture.hpp"
+
 VertexBuffer::VertexBuffer(const void* data, size_t size) {
     glGenBuffers(1, &vbo);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    GLCapture::createBuffer(vbo, data, size);
+
+#if defined(V2_GL_DEBUG)
+    char name[64];
+    std::snprintf(name, sizeof(name), "VertexBuffer %u (%zu bytes)", vbo, size);
+    DebugOutput::label(GL_BUFFER, vbo, name);
+#endif
 }
 
 VertexBuffer::~VertexBuffer() {
     glDeleteBuffers(1, &vbo);
+    GLCapture::deleteBuffer(vbo);
 }
 
 void VertexBuffer::bind() const {
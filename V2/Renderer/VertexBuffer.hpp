@@ -10,6 +10,8 @@ public:
 
     void bind() const;
     void unbind() const;
+
+    GLuint id() const { return vbo; }
 private:    
    GLuint vbo = 0;
 };
\ No newline at end of file
@@ -0,0 +1,445 @@
+#include "Bvh.hpp"
+#include "Core/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace {
+
+constexpr int kBins = 16;
+constexpr uint32_t kMaxLeafSize = 4;
+
+// keeps the traversal stacks below a fixed size
+constexpr uint32_t kMaxDepth = 60;
+constexpr int kStackSize = 64;
+
+// traversal cost relative to one box test
+constexpr float kTraversalCost = 1.0f;
+
+float area(const float* bmin, const float* bmax) {
+    float dx = bmax[0] - bmin[0], dy = bmax[1] - bmin[1], dz = bmax[2] - bmin[2];
+    if (dx < 0.0f || dy < 0.0f || dz < 0.0f) return 0.0f;
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+float axisOf(const Vec3& v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+enum class PlaneResult { Outside, Inside, Intersect };
+
+PlaneResult classify(const Frustum& f, const float* bmin, const float* bmax) {
+    PlaneResult result = PlaneResult::Inside;
+    for (const Vec4& p : f.planes) {
+        float cx = (bmin[0] + bmax[0]) * 0.5f, ex = (bmax[0] - bmin[0]) * 0.5f;
+        float cy = (bmin[1] + bmax[1]) * 0.5f, ey = (bmax[1] - bmin[1]) * 0.5f;
+        float cz = (bmin[2] + bmax[2]) * 0.5f, ez = (bmax[2] - bmin[2]) * 0.5f;
+        float d = p.x * cx + p.y * cy + p.z * cz + p.w;
+        float r = std::fabs(p.x) * ex + std::fabs(p.y) * ey + std::fabs(p.z) * ez;
+        if (d + r < 0.0f) return PlaneResult::Outside;
+        if (d - r < 0.0f) result = PlaneResult::Intersect;
+    }
+    return result;
+}
+
+// Slab test, returns entry distance or FLT_MAX on a miss
+float intersectRay(const Vec3& o, const Vec3& invDir, float maxT, const float* bmin, const float* bmax) {
+    float tx1 = (bmin[0] - o.x) * invDir.x, tx2 = (bmax[0] - o.x) * invDir.x;
+    float tmin = std::min(tx1, tx2), tmax = std::max(tx1, tx2);
+    float ty1 = (bmin[1] - o.y) * invDir.y, ty2 = (bmax[1] - o.y) * invDir.y;
+    tmin = std::max(tmin, std::min(ty1, ty2)); tmax = std::min(tmax, std::max(ty1, ty2));
+    float tz1 = (bmin[2] - o.z) * invDir.z, tz2 = (bmax[2] - o.z) * invDir.z;
+    tmin = std::max(tmin, std::min(tz1, tz2)); tmax = std::min(tmax, std::max(tz1, tz2));
+    if (tmax >= std::max(tmin, 0.0f) && tmin <= maxT) return std::max(tmin, 0.0f);
+    return FLT_MAX;
+}
+
+void toArrays(const AABB& b, float* bmin, float* bmax) {
+    bmin[0] = b.min.x; bmin[1] = b.min.y; bmin[2] = b.min.z;
+    bmax[0] = b.max.x; bmax[1] = b.max.y; bmax[2] = b.max.z;
+}
+
+} // namespace
+
+// Recursive binned SAH build, writes nodes in depth-first order
+struct BvhBuilder {
+    const std::vector<AABB>& boxes;
+    std::vector<Vec3> centroids;
+    std::vector<uint32_t>& prims;
+    std::vector<Bvh::Node>& nodes;
+
+    void build(uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t depth) {
+        AABB bounds, centroidBounds;
+        for (uint32_t i = first; i < first + count; i++) {
+            bounds.expand(boxes[prims[i]]);
+            centroidBounds.expand(centroids[prims[i]]);
+        }
+        toArrays(bounds, nodes[nodeIndex].bmin, nodes[nodeIndex].bmax);
+        nodes[nodeIndex].index = first;
+        nodes[nodeIndex].count = count;
+
+        if (count <= kMaxLeafSize || depth >= kMaxDepth) {
+            return;
+        }
+
+        // binned SAH over all three axes
+        int bestAxis = -1;
+        int bestSplit = 0;
+        float bestCost = FLT_MAX;
+        for (int axis = 0; axis < 3; axis++) {
+            float lo = axisOf(centroidBounds.min, axis), hi = axisOf(centroidBounds.max, axis);
+            if (hi - lo <= 1e-6f) continue;
+            float scale = kBins / (hi - lo);
+
+            AABB binBounds[kBins];
+            uint32_t binCount[kBins] = {};
+            for (uint32_t i = first; i < first + count; i++) {
+                uint32_t p = prims[i];
+                int b = std::min(kBins - 1, static_cast<int>((axisOf(centroids[p], axis) - lo) * scale));
+                binCount[b]++;
+                binBounds[b].expand(boxes[p]);
+            }
+
+            // suffix sweep from the right, then prefix sweep from the left
+            float rightArea[kBins] = {};
+            uint32_t rightCount[kBins] = {};
+            AABB acc;
+            uint32_t n = 0;
+            for (int b = kBins - 1; b > 0; b--) {
+                acc.expand(binBounds[b]);
+                n += binCount[b];
+                rightArea[b] = acc.valid() ? acc.surfaceArea() : 0.0f;
+                rightCount[b] = n;
+            }
+            acc = AABB{};
+            n = 0;
+            for (int b = 0; b < kBins - 1; b++) {
+                acc.expand(binBounds[b]);
+                n += binCount[b];
+                if (n == 0 || rightCount[b + 1] == 0) continue;
+                float cost = (acc.valid() ? acc.surfaceArea() : 0.0f) * n + rightArea[b + 1] * rightCount[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b;
+                }
+            }
+        }
+
+        float parentArea = bounds.surfaceArea();
+        if (bestAxis < 0 || kTraversalCost * parentArea + bestCost >= parentArea * count) {
+            return; // splitting does not pay off
+        }
+
+        float lo = axisOf(centroidBounds.min, bestAxis), hi = axisOf(centroidBounds.max, bestAxis);
+        float scale = kBins / (hi - lo);
+        auto mid = std::partition(prims.begin() + first, prims.begin() + first + count, [&](uint32_t p) {
+            int b = std::min(kBins - 1, static_cast<int>((axisOf(centroids[p], bestAxis) - lo) * scale));
+            return b <= bestSplit;
+        });
+        uint32_t leftCount = static_cast<uint32_t>(mid - prims.begin()) - first;
+        if (leftCount == 0 || leftCount == count) {
+            return;
+        }
+
+        // left child right after the parent, right child after the whole left subtree
+        uint32_t leftIndex = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+        build(leftIndex, first, leftCount, depth + 1);
+
+        uint32_t rightIndex = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+        build(rightIndex, first + leftCount, count - leftCount, depth + 1);
+
+        nodes[nodeIndex].index = rightIndex;
+        nodes[nodeIndex].count = 0;
+    }
+};
+
+Bvh::Bvh(ThreadPool* pool) : pool(pool) {}
+
+Bvh::~Bvh() {
+    if (rebuildDone.valid()) {
+        rebuildDone.wait();
+    }
+}
+
+uint32_t Bvh::insert(const AABB& bounds) {
+    uint32_t id = static_cast<uint32_t>(boxes.size());
+    boxes.push_back(bounds);
+    alive.push_back(1);
+    pending.push_back(id);
+    return id;
+}
+
+void Bvh::move(uint32_t id, const AABB& bounds) {
+    boxes[id] = bounds;
+    moved = true;
+}
+
+void Bvh::remove(uint32_t id) {
+    // an empty box drops out of every query and refit
+    boxes[id] = AABB{};
+    alive[id] = 0;
+    moved = true;
+}
+
+void Bvh::buildTree(const std::vector<AABB>& boxes, const std::vector<uint8_t>& alive, uint32_t objectCount, Tree& tree) {
+    tree.nodes.clear();
+    tree.prims.clear();
+    tree.objectCount = objectCount;
+
+    BvhBuilder builder{ boxes, std::vector<Vec3>(objectCount), tree.prims, tree.nodes };
+    for (uint32_t i = 0; i < objectCount; i++) {
+        if (alive[i]) {
+            tree.prims.push_back(i);
+            builder.centroids[i] = boxes[i].center();
+        }
+    }
+    if (tree.prims.empty()) {
+        tree.builtCost = 0.0f;
+        return;
+    }
+
+    tree.nodes.reserve(tree.prims.size());
+    tree.nodes.emplace_back();
+    builder.build(0, 0, static_cast<uint32_t>(tree.prims.size()), 0);
+    tree.builtCost = sahCost(tree.nodes);
+}
+
+float Bvh::sahCost(const std::vector<Node>& nodes) {
+    if (nodes.empty()) return 0.0f;
+    float rootArea = area(nodes[0].bmin, nodes[0].bmax);
+    if (rootArea <= 0.0f) return 0.0f;
+
+    float cost = 0.0f;
+    for (const Node& n : nodes) {
+        float a = area(n.bmin, n.bmax);
+        cost += n.count ? a * n.count : a * kTraversalCost;
+    }
+    return cost / rootArea;
+}
+
+void Bvh::build() {
+    if (rebuildDone.valid()) {
+        rebuildDone.wait();
+        rebuildDone = {};
+        rebuildResult.reset();
+    }
+    buildTree(boxes, alive, static_cast<uint32_t>(boxes.size()), tree);
+    pending.clear();
+    currentCost = tree.builtCost;
+    moved = false;
+    rebuildCount++;
+}
+
+void Bvh::refit() {
+    // children always sit after their parent, so one backwards pass is enough
+    for (size_t i = tree.nodes.size(); i-- > 0;) {
+        Node& n = tree.nodes[i];
+        AABB b;
+        if (n.count) {
+            for (uint32_t p = n.index; p < n.index + n.count; p++) {
+                b.expand(boxes[tree.prims[p]]);
+            }
+            toArrays(b, n.bmin, n.bmax);
+        } else {
+            const Node& l = tree.nodes[i + 1];
+            const Node& r = tree.nodes[n.index];
+            for (int a = 0; a < 3; a++) {
+                n.bmin[a] = std::min(l.bmin[a], r.bmin[a]);
+                n.bmax[a] = std::max(l.bmax[a], r.bmax[a]);
+            }
+        }
+    }
+    currentCost = sahCost(tree.nodes);
+}
+
+void Bvh::startRebuild() {
+    // the worker gets its own copy of the boxes, objects keep moving meanwhile
+    auto result = std::make_shared<Tree>();
+    auto snapshotBoxes = std::make_shared<std::vector<AABB>>(boxes);
+    auto snapshotAlive = std::make_shared<std::vector<uint8_t>>(alive);
+    auto done = std::make_shared<std::promise<void>>();
+
+    rebuildResult = result;
+    rebuildDone = done->get_future();
+
+    pool->submit([result, snapshotBoxes, snapshotAlive, done] {
+        buildTree(*snapshotBoxes, *snapshotAlive, static_cast<uint32_t>(snapshotBoxes->size()), *result);
+        done->set_value();
+    });
+}
+
+void Bvh::update() {
+    if (rebuildDone.valid() &&
+        rebuildDone.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        rebuildDone = {};
+        tree = std::move(*rebuildResult);
+        rebuildResult.reset();
+        rebuildCount++;
+
+        // whatever was inserted while the worker was busy stays pending
+        uint32_t built = tree.objectCount;
+        pending.erase(std::remove_if(pending.begin(), pending.end(),
+            [built](uint32_t id) { return id < built; }), pending.end());
+
+        // boxes moved since the snapshot
+        refit();
+        moved = false;
+    }
+
+    if (tree.nodes.empty()) {
+        if (!pending.empty()) build();
+        return;
+    }
+
+    if (moved) {
+        refit();
+        moved = false;
+    }
+
+    bool degraded = currentCost > tree.builtCost * rebuildThreshold;
+    bool tooManyPending = pending.size() > 64 && pending.size() * 8 > tree.prims.size();
+    if ((degraded || tooManyPending) && !rebuildDone.valid()) {
+        if (pool) {
+            startRebuild();
+        } else {
+            build();
+        }
+    }
+}
+
+void Bvh::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& out) const {
+    out.clear();
+    if (!tree.nodes.empty()) {
+        // inside[]: node known to be fully inside, its children skip the plane tests
+        uint32_t stack[kStackSize];
+        bool inside[kStackSize];
+        int top = 0;
+        stack[top] = 0; inside[top] = false; top++;
+
+        while (top > 0) {
+            top--;
+            uint32_t ni = stack[top];
+            bool fullyInside = inside[top];
+            const Node& n = tree.nodes[ni];
+
+            if (!fullyInside) {
+                PlaneResult r = classify(frustum, n.bmin, n.bmax);
+                if (r == PlaneResult::Outside) continue;
+                fullyInside = r == PlaneResult::Inside;
+            }
+
+            if (n.count) {
+                for (uint32_t p = n.index; p < n.index + n.count; p++) {
+                    uint32_t id = tree.prims[p];
+                    if (alive[id] && (fullyInside || frustum.intersects(boxes[id]))) out.push_back(id);
+                }
+            } else {
+                stack[top] = n.index; inside[top] = fullyInside; top++;
+                stack[top] = ni + 1;  inside[top] = fullyInside; top++;
+            }
+        }
+    }
+
+    for (uint32_t id : pending) {
+        if (alive[id] && frustum.intersects(boxes[id])) out.push_back(id);
+    }
+}
+
+void Bvh::queryOverlap(const AABB& box, std::vector<uint32_t>& out) const {
+    out.clear();
+    if (!tree.nodes.empty()) {
+        uint32_t stack[kStackSize];
+        int top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const Node& n = tree.nodes[stack[--top]];
+            uint32_t ni = static_cast<uint32_t>(&n - tree.nodes.data());
+            if (n.bmin[0] > box.max.x || n.bmax[0] < box.min.x ||
+                n.bmin[1] > box.max.y || n.bmax[1] < box.min.y ||
+                n.bmin[2] > box.max.z || n.bmax[2] < box.min.z) {
+                continue;
+            }
+
+            if (n.count) {
+                for (uint32_t p = n.index; p < n.index + n.count; p++) {
+                    uint32_t id = tree.prims[p];
+                    if (alive[id] && boxes[id].overlaps(box)) out.push_back(id);
+                }
+            } else {
+                stack[top++] = n.index;
+                stack[top++] = ni + 1;
+            }
+        }
+    }
+
+    for (uint32_t id : pending) {
+        if (alive[id] && boxes[id].overlaps(box)) out.push_back(id);
+    }
+}
+
+bool Bvh::raycast(const Vec3& origin, const Vec3& dir, float maxT, RayHit& hit) const {
+    Vec3 invDir(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+    float best = maxT;
+    bool found = false;
+
+    auto testObject = [&](uint32_t id) {
+        if (!alive[id]) return;
+        float bmin[3], bmax[3];
+        toArrays(boxes[id], bmin, bmax);
+        float t = intersectRay(origin, invDir, best, bmin, bmax);
+        if (t != FLT_MAX && (!found || t < best)) {
+            best = t;
+            hit.id = id;
+            hit.t = t;
+            found = true;
+        }
+    };
+
+    if (!tree.nodes.empty() && intersectRay(origin, invDir, best, tree.nodes[0].bmin, tree.nodes[0].bmax) != FLT_MAX) {
+        uint32_t stack[kStackSize];
+        int top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            uint32_t ni = stack[--top];
+            const Node& n = tree.nodes[ni];
+
+            if (n.count) {
+                for (uint32_t p = n.index; p < n.index + n.count; p++) {
+                    testObject(tree.prims[p]);
+                }
+                continue;
+            }
+
+            // visit the nearer child first, skip children farther than the best hit
+            uint32_t a = ni + 1, b = n.index;
+            float ta = intersectRay(origin, invDir, best, tree.nodes[a].bmin, tree.nodes[a].bmax);
+            float tb = intersectRay(origin, invDir, best, tree.nodes[b].bmin, tree.nodes[b].bmax);
+            if (ta > tb) {
+                std::swap(a, b);
+                std::swap(ta, tb);
+            }
+            if (tb != FLT_MAX && top < kStackSize) stack[top++] = b;
+            if (ta != FLT_MAX && top < kStackSize) stack[top++] = a;
+        }
+    }
+
+    for (uint32_t id : pending) {
+        testObject(id);
+    }
+    return found;
+}
+
+BvhStats Bvh::stats() const {
+    BvhStats s;
+    s.nodes = tree.nodes.size();
+    s.objects = static_cast<size_t>(std::count(alive.begin(), alive.end(), 1));
+    s.pending = pending.size();
+    s.rebuilds = rebuildCount;
+    s.sahCost = tree.builtCost > 0.0f ? currentCost / tree.builtCost : 1.0f;
+    return s;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "Math/Bounds.hpp"
+
+class ThreadPool;
+struct BvhBuilder;
+
+struct RayHit {
+    uint32_t id = 0;
+    float t = 0.0f;
+};
+
+struct BvhStats {
+    size_t nodes = 0;
+    size_t objects = 0;
+    size_t pending = 0;     // inserted since the last build, tested brute force until the next one
+    size_t rebuilds = 0;
+    float sahCost = 0.0f;   // current cost relative to the cost right after the last build
+};
+
+// Bounding volume hierarchy over world space boxes (usually Mesh bounds * world matrix).
+// Built top-down with binned SAH into a flat depth-first node array: the left child of
+// a node is always the next node, only the right child index is stored.
+// Moving objects refits the tree; once the refitted tree has degraded enough a fresh
+// build runs on the thread pool and is swapped in by a later update().
+class Bvh {
+public:
+    explicit Bvh(ThreadPool* pool = nullptr);
+    ~Bvh();
+
+    Bvh(const Bvh&) = delete;
+    Bvh& operator=(const Bvh&) = delete;
+
+    // ids are never reused
+    uint32_t insert(const AABB& bounds);
+    void move(uint32_t id, const AABB& bounds);
+    void remove(uint32_t id);
+
+    // Synchronous full build
+    void build();
+
+    // Once per frame: picks up a finished background build, refits moved objects
+    // and starts a new background build when the tree got too bad
+    void update();
+
+    void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& out) const;
+    void queryOverlap(const AABB& box, std::vector<uint32_t>& out) const;
+    // Closest object box hit by origin + t * dir, t in [0, maxT]
+    bool raycast(const Vec3& origin, const Vec3& dir, float maxT, RayHit& hit) const;
+
+    BvhStats stats() const;
+
+    // refitted cost / built cost above which a rebuild is started
+    float rebuildThreshold = 1.4f;
+private:
+    friend struct BvhBuilder;
+
+    struct Node {
+        float bmin[3];
+        float bmax[3];
+        uint32_t index; // right child for inner nodes, first prim for leaves
+        uint32_t count; // 0 for inner nodes
+    };
+    static_assert(sizeof(Node) == 32, "two nodes per cache line");
+
+    struct Tree {
+        std::vector<Node> nodes;
+        std::vector<uint32_t> prims;
+        uint32_t objectCount = 0; // ids below this were part of the build
+        float builtCost = 0.0f;
+    };
+
+    static void buildTree(const std::vector<AABB>& boxes, const std::vector<uint8_t>& alive, uint32_t objectCount, Tree& tree);
+    static float sahCost(const std::vector<Node>& nodes);
+
+    void refit();
+    void startRebuild();
+
+    ThreadPool* pool;
+
+    std::vector<AABB> boxes;
+    std::vector<uint8_t> alive;
+    std::vector<uint32_t> pending;
+    bool moved = false;
+
+    Tree tree;
+    float currentCost = 0.0f;
+    size_t rebuildCount = 0;
+
+    std::shared_ptr<Tree> rebuildResult;
+    std::future<void> rebuildDone;
+};
@@ -0,0 +1,141 @@
+#include "FrustumCuller.hpp"
+#include "Core/ThreadPool.hpp"
+
+#include <chrono>
+
+namespace {
+
+// boxes per thread job, multiple of 8 so the SIMD loops never straddle jobs
+constexpr size_t kChunkSize = 4096;
+
+struct PlaneSet {
+    float x[6], y[6], z[6], w[6];
+    float ax[6], ay[6], az[6]; // absolute normals for the extent projection
+};
+
+PlaneSet unpack(const Frustum& f) {
+    PlaneSet p;
+    for (int i = 0; i < 6; i++) {
+        p.x[i] = f.planes[i].x;
+        p.y[i] = f.planes[i].y;
+        p.z[i] = f.planes[i].z;
+        p.w[i] = f.planes[i].w;
+        p.ax[i] = std::fabs(p.x[i]);
+        p.ay[i] = std::fabs(p.y[i]);
+        p.az[i] = std::fabs(p.z[i]);
+    }
+    return p;
+}
+
+// Loops the set bits of a lane mask and appends base + lane to out
+inline void appendMask(unsigned mask, uint32_t base, std::vector<uint32_t>& out) {
+    while (mask) {
+        unsigned lane = 0;
+        while (!(mask & (1u << lane))) lane++;
+        out.push_back(base + lane);
+        mask &= mask - 1;
+    }
+}
+
+} // namespace
+
+FrustumCuller::FrustumCuller(ThreadPool* pool) : pool(pool) {}
+
+void FrustumCuller::clear() {
+    cx.clear(); cy.clear(); cz.clear();
+    ex.clear(); ey.clear(); ez.clear();
+}
+
+uint32_t FrustumCuller::add(const AABB& worldBounds) {
+    uint32_t index = static_cast<uint32_t>(cx.size());
+    cx.push_back(0); cy.push_back(0); cz.push_back(0);
+    ex.push_back(0); ey.push_back(0); ez.push_back(0);
+    set(index, worldBounds);
+    return index;
+}
+
+void FrustumCuller::set(uint32_t index, const AABB& worldBounds) {
+    Vec3 c = worldBounds.center(), e = worldBounds.extents();
+    cx[index] = c.x; cy[index] = c.y; cz[index] = c.z;
+    ex[index] = e.x; ey[index] = e.y; ez[index] = e.z;
+}
+
+void FrustumCuller::cullRange(const Frustum& frustum, uint32_t begin, uint32_t end, std::vector<uint32_t>& out) const {
+    PlaneSet p = unpack(frustum);
+    uint32_t i = begin;
+
+#if defined(MATH_SIMD_AVX)
+    for (; i + 8 <= end; i += 8) {
+        __m256 bx = _mm256_loadu_ps(&cx[i]), by = _mm256_loadu_ps(&cy[i]), bz = _mm256_loadu_ps(&cz[i]);
+        __m256 rx = _mm256_loadu_ps(&ex[i]), ry = _mm256_loadu_ps(&ey[i]), rz = _mm256_loadu_ps(&ez[i]);
+        unsigned mask = 0xFF;
+        for (int k = 0; k < 6 && mask; k++) {
+            __m256 d = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.x[k]), bx), _mm256_mul_ps(_mm256_set1_ps(p.y[k]), by)),
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.z[k]), bz), _mm256_set1_ps(p.w[k])));
+            __m256 r = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.ax[k]), rx), _mm256_mul_ps(_mm256_set1_ps(p.ay[k]), ry)),
+                _mm256_mul_ps(_mm256_set1_ps(p.az[k]), rz));
+            __m256 inside = _mm256_cmp_ps(_mm256_add_ps(d, r), _mm256_setzero_ps(), _CMP_GE_OQ);
+            mask &= static_cast<unsigned>(_mm256_movemask_ps(inside));
+        }
+        appendMask(mask, i, out);
+    }
+#endif
+
+#if defined(MATH_SIMD_SSE)
+    for (; i + 4 <= end; i += 4) {
+        __m128 bx = _mm_loadu_ps(&cx[i]), by = _mm_loadu_ps(&cy[i]), bz = _mm_loadu_ps(&cz[i]);
+        __m128 rx = _mm_loadu_ps(&ex[i]), ry = _mm_loadu_ps(&ey[i]), rz = _mm_loadu_ps(&ez[i]);
+        unsigned mask = 0xF;
+        for (int k = 0; k < 6 && mask; k++) {
+            __m128 d = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x[k]), bx), _mm_mul_ps(_mm_set1_ps(p.y[k]), by)),
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.z[k]), bz), _mm_set1_ps(p.w[k])));
+            __m128 r = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.ax[k]), rx), _mm_mul_ps(_mm_set1_ps(p.ay[k]), ry)),
+                _mm_mul_ps(_mm_set1_ps(p.az[k]), rz));
+            mask &= static_cast<unsigned>(_mm_movemask_ps(_mm_cmpge_ps(_mm_add_ps(d, r), _mm_setzero_ps())));
+        }
+        appendMask(mask, i, out);
+    }
+#endif
+
+    for (; i < end; i++) {
+        bool inside = true;
+        for (int k = 0; k < 6 && inside; k++) {
+            float d = p.x[k] * cx[i] + p.y[k] * cy[i] + p.z[k] * cz[i] + p.w[k];
+            float r = p.ax[k] * ex[i] + p.ay[k] * ey[i] + p.az[k] * ez[i];
+            inside = d + r >= 0.0f;
+        }
+        if (inside) out.push_back(i);
+    }
+}
+
+void FrustumCuller::cull(const Frustum& frustum, std::vector<uint32_t>& visible) {
+    auto start = std::chrono::steady_clock::now();
+    visible.clear();
+
+    size_t n = size();
+    size_t chunks = (n + kChunkSize - 1) / kChunkSize;
+
+    if (!pool || chunks <= 1) {
+        cullRange(frustum, 0, static_cast<uint32_t>(n), visible);
+    } else {
+        // each job writes its own list, stitched together in order afterwards
+        if (chunkResults.size() < chunks) chunkResults.resize(chunks);
+        pool->parallelFor(n, kChunkSize, [&](size_t b, size_t e) {
+            std::vector<uint32_t>& out = chunkResults[b / kChunkSize];
+            out.clear();
+            cullRange(frustum, static_cast<uint32_t>(b), static_cast<uint32_t>(e), out);
+        });
+        for (size_t c = 0; c < chunks; c++) {
+            visible.insert(visible.end(), chunkResults[c].begin(), chunkResults[c].end());
+        }
+    }
+
+    lastStats.tested = n;
+    lastStats.visible = visible.size();
+    lastStats.culled = n - visible.size();
+    lastStats.cullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
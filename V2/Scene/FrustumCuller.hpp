@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/Bounds.hpp"
+
+class ThreadPool;
+
+struct CullStats {
+    size_t tested = 0;
+    size_t visible = 0;
+    size_t culled = 0;
+    double cullMs = 0.0;
+};
+
+// Tests world space boxes against the 6 frustum planes, 4 (SSE) or 8 (AVX)
+// boxes per iteration. Boxes are kept packed as center/extents SoA.
+class FrustumCuller {
+public:
+    explicit FrustumCuller(ThreadPool* pool = nullptr);
+
+    void clear();
+    uint32_t add(const AABB& worldBounds);
+    void set(uint32_t index, const AABB& worldBounds);
+    size_t size() const { return cx.size(); }
+
+    // Fills visible with the indices (in add order) of boxes touching the frustum
+    void cull(const Frustum& frustum, std::vector<uint32_t>& visible);
+
+    const CullStats& stats() const { return lastStats; }
+private:
+    void cullRange(const Frustum& frustum, uint32_t begin, uint32_t end, std::vector<uint32_t>& out) const;
+
+    ThreadPool* pool;
+
+    std::vector<float> cx, cy, cz;
+    std::vector<float> ex, ey, ez;
+
+    std::vector<std::vector<uint32_t>> chunkResults;
+    CullStats lastStats;
+};
@@ -0,0 +1,284 @@
+#include "TransformHierarchy.hpp"
+#include "Core/ThreadPool.hpp"
+
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+inline uint32_t countTrailingZeros(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, v);
+    return static_cast<uint32_t>(idx);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(v));
+#endif
+}
+
+inline uint32_t popCount(uint64_t v) {
+#if defined(_MSC_VER)
+    return static_cast<uint32_t>(__popcnt64(v));
+#else
+    return static_cast<uint32_t>(__builtin_popcountll(v));
+#endif
+}
+
+void setBits(std::vector<uint64_t>& bits, uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end;) {
+        uint32_t word = i >> 6;
+        uint32_t bit = i & 63;
+        uint32_t n = std::min<uint32_t>(64 - bit, end - i);
+        uint64_t mask = (n == 64) ? ~0ull : (((1ull << n) - 1) << bit);
+        bits[word] |= mask;
+        i += n;
+    }
+}
+
+// First index in [i, end) whose bit equals `value`, or end
+uint32_t findBit(const std::vector<uint64_t>& bits, uint32_t i, uint32_t end, bool value) {
+    while (i < end) {
+        uint64_t word = bits[i >> 6];
+        if (!value) word = ~word;
+        word &= ~0ull << (i & 63);
+        if (word) {
+            return std::min(end, (i & ~63u) + countTrailingZeros(word));
+        }
+        i = (i & ~63u) + 64;
+    }
+    return end;
+}
+
+} // namespace
+
+TransformHierarchy::TransformHierarchy(ThreadPool* pool) : pool(pool) {}
+
+TransformHierarchy::Handle TransformHierarchy::create(Handle parentHandle, const Vec3& t, const Quat& r, const Vec3& s) {
+    uint32_t index = static_cast<uint32_t>(parent.size());
+    uint32_t p = parentHandle == kNoParent ? kNoParent : handleToIndex[parentHandle];
+
+    // Appending under the last opened subtree keeps depth-first order,
+    // anything else gets sorted at the next update()
+    if (!orderDirty && (p == kNoParent || subtreeEnd[p] == index)) {
+        for (uint32_t a = p; a != kNoParent; a = parent[a]) {
+            subtreeEnd[a] = index + 1;
+        }
+    } else {
+        orderDirty = true;
+    }
+
+    parent.push_back(p);
+    subtreeEnd.push_back(index + 1);
+    local.push(t, r, s);
+    localMatrix.emplace_back();
+    worldMatrix.push_back(Mat4::identity());
+    dirty.resize((parent.size() + 63) / 64, 0);
+
+    Handle h = static_cast<Handle>(handleToIndex.size());
+    handleToIndex.push_back(index);
+    indexToHandle.push_back(h);
+
+    setBits(dirty, index, index + 1);
+    jobs.clear();
+    return h;
+}
+
+void TransformHierarchy::markDirty(uint32_t index) {
+    if (orderDirty) {
+        // everything is recomputed after the reorder anyway
+        setBits(dirty, index, index + 1);
+    } else {
+        setBits(dirty, index, subtreeEnd[index]);
+    }
+}
+
+void TransformHierarchy::setLocal(Handle h, const Vec3& t, const Quat& r, const Vec3& s) {
+    uint32_t i = handleToIndex[h];
+    local.set(i, t, r, s);
+    markDirty(i);
+}
+
+void TransformHierarchy::setTranslation(Handle h, const Vec3& t) {
+    uint32_t i = handleToIndex[h];
+    local.tx[i] = t.x; local.ty[i] = t.y; local.tz[i] = t.z;
+    markDirty(i);
+}
+
+void TransformHierarchy::setRotation(Handle h, const Quat& r) {
+    uint32_t i = handleToIndex[h];
+    local.qx[i] = r.x; local.qy[i] = r.y; local.qz[i] = r.z; local.qw[i] = r.w;
+    markDirty(i);
+}
+
+void TransformHierarchy::setScale(Handle h, const Vec3& s) {
+    uint32_t i = handleToIndex[h];
+    local.sx[i] = s.x; local.sy[i] = s.y; local.sz[i] = s.z;
+    markDirty(i);
+}
+
+void TransformHierarchy::rebuildOrder() {
+    uint32_t n = static_cast<uint32_t>(parent.size());
+
+    // children lists (CSR), siblings stay in creation order
+    std::vector<uint32_t> childStart(n + 1, 0);
+    for (uint32_t i = 0; i < n; i++) {
+        if (parent[i] != kNoParent) childStart[parent[i] + 1]++;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        childStart[i + 1] += childStart[i];
+    }
+    std::vector<uint32_t> children(childStart[n]);
+    std::vector<uint32_t> fill(childStart.begin(), childStart.end() - 1);
+    for (uint32_t i = 0; i < n; i++) {
+        if (parent[i] != kNoParent) children[fill[parent[i]]++] = i;
+    }
+
+    // depth-first walk from every root
+    std::vector<uint32_t> order;
+    order.reserve(n);
+    std::vector<uint32_t> stack;
+    for (uint32_t root = 0; root < n; root++) {
+        if (parent[root] != kNoParent) continue;
+        stack.push_back(root);
+        while (!stack.empty()) {
+            uint32_t i = stack.back();
+            stack.pop_back();
+            order.push_back(i);
+            for (uint32_t c = childStart[i + 1]; c > childStart[i]; c--) {
+                stack.push_back(children[c - 1]);
+            }
+        }
+    }
+
+    std::vector<uint32_t> oldToNew(n);
+    for (uint32_t i = 0; i < n; i++) {
+        oldToNew[order[i]] = i;
+    }
+
+    std::vector<uint32_t> newParent(n);
+    std::vector<uint32_t> newIndexToHandle(n);
+    TransformSoA newLocal;
+    newLocal.resize(n);
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t old = order[i];
+        newParent[i] = parent[old] == kNoParent ? kNoParent : oldToNew[parent[old]];
+        newIndexToHandle[i] = indexToHandle[old];
+        newLocal.set(i,
+            { local.tx[old], local.ty[old], local.tz[old] },
+            { local.qx[old], local.qy[old], local.qz[old], local.qw[old] },
+            { local.sx[old], local.sy[old], local.sz[old] });
+    }
+    parent.swap(newParent);
+    indexToHandle.swap(newIndexToHandle);
+    local = std::move(newLocal);
+    for (uint32_t i = 0; i < n; i++) {
+        handleToIndex[indexToHandle[i]] = i;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        subtreeEnd[i] = i + 1;
+    }
+    for (uint32_t i = n; i-- > 0;) {
+        if (parent[i] != kNoParent) {
+            subtreeEnd[parent[i]] = std::max(subtreeEnd[parent[i]], subtreeEnd[i]);
+        }
+    }
+
+    setBits(dirty, 0, n);
+    orderDirty = false;
+    jobs.clear();
+}
+
+void TransformHierarchy::partition() {
+    serialNodes.clear();
+    jobs.clear();
+
+    uint32_t n = static_cast<uint32_t>(parent.size());
+    unsigned threads = pool ? pool->concurrency() : 1;
+    uint32_t target = std::max<uint32_t>(256, n / (threads * 4));
+
+    // subtrees bigger than target get their root done serially and their children split up
+    std::vector<uint32_t> stack;
+    for (uint32_t root = 0; root < n; root = subtreeEnd[root]) {
+        stack.push_back(root);
+        while (!stack.empty()) {
+            uint32_t i = stack.back();
+            stack.pop_back();
+            uint32_t end = subtreeEnd[i];
+
+            if (end - i <= target || threads == 1) {
+                if (!jobs.empty() && jobs.back().end == i && end - jobs.back().begin <= target) {
+                    jobs.back().end = end; // glue small neighbouring subtrees together
+                } else {
+                    jobs.push_back({ i, end });
+                }
+                continue;
+            }
+
+            serialNodes.push_back(i);
+            std::vector<uint32_t> kids;
+            for (uint32_t c = i + 1; c < end; c = subtreeEnd[c]) {
+                kids.push_back(c);
+            }
+            stack.insert(stack.end(), kids.rbegin(), kids.rend());
+        }
+    }
+}
+
+void TransformHierarchy::updateRun(uint32_t begin, uint32_t end) {
+    composeTRSSimd(local, begin, end - begin, &localMatrix[begin]);
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t p = parent[i];
+        worldMatrix[i] = p == kNoParent ? localMatrix[i] : worldMatrix[p] * localMatrix[i];
+    }
+}
+
+void TransformHierarchy::updateRange(uint32_t begin, uint32_t end) {
+    uint32_t i = findBit(dirty, begin, end, true);
+    while (i < end) {
+        uint32_t runEnd = findBit(dirty, i, end, false);
+        updateRun(i, runEnd);
+        i = findBit(dirty, runEnd, end, true);
+    }
+}
+
+void TransformHierarchy::update() {
+    if (orderDirty) {
+        rebuildOrder();
+    }
+    if (jobs.empty() && !parent.empty()) {
+        partition();
+    }
+
+    updatedCount = 0;
+    for (uint64_t word : dirty) {
+        updatedCount += popCount(word);
+    }
+    if (updatedCount == 0) {
+        return;
+    }
+
+    for (uint32_t i : serialNodes) {
+        if (dirty[i >> 6] & (1ull << (i & 63))) {
+            updateRun(i, i + 1);
+        }
+    }
+
+    // the bitset is only read while the jobs run, cleared once they are all done
+    if (pool && jobs.size() > 1) {
+        pool->parallelFor(jobs.size(), 1, [this](size_t b, size_t e) {
+            for (size_t j = b; j < e; j++) {
+                updateRange(jobs[j].begin, jobs[j].end);
+            }
+        });
+    } else {
+        for (const Range& r : jobs) {
+            updateRange(r.begin, r.end);
+        }
+    }
+
+    std::fill(dirty.begin(), dirty.end(), 0);
+}
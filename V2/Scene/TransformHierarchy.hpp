@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/Math.hpp"
+#include "Math/TransformBatch.hpp"
+
+class ThreadPool;
+
+// Flat parent/child transform tree.
+// Nodes are kept in depth-first order internally, so every subtree is one
+// contiguous index range and parents always come before their children.
+// Local TRS is stored SoA, a dirty bitset tracks what needs recomputing and
+// update() only touches dirty subtrees, spread over the thread pool when one is given.
+class TransformHierarchy {
+public:
+    using Handle = uint32_t;
+    static constexpr Handle kNoParent = 0xFFFFFFFFu;
+
+    explicit TransformHierarchy(ThreadPool* pool = nullptr);
+
+    Handle create(Handle parent = kNoParent,
+                  const Vec3& t = {}, const Quat& r = {}, const Vec3& s = { 1.0f, 1.0f, 1.0f });
+
+    void setLocal(Handle h, const Vec3& t, const Quat& r, const Vec3& s);
+    void setTranslation(Handle h, const Vec3& t);
+    void setRotation(Handle h, const Quat& r);
+    void setScale(Handle h, const Vec3& s);
+
+    // Recomputes world matrices for dirty subtrees
+    void update();
+
+    const Mat4& world(Handle h) const { return worldMatrix[handleToIndex[h]]; }
+
+    // World matrices in internal (depth-first) order, e.g. for a single instance buffer upload.
+    // indexOf() maps a handle into this array.
+    const Mat4* worldMatrices() const { return worldMatrix.data(); }
+    uint32_t indexOf(Handle h) const { return handleToIndex[h]; }
+    size_t size() const { return parent.size(); }
+
+    // Nodes recomputed by the last update()
+    size_t lastUpdateCount() const { return updatedCount; }
+private:
+    struct Range {
+        uint32_t begin, end;
+    };
+
+    void rebuildOrder();
+    void partition();
+    void markDirty(uint32_t index);
+    void updateRange(uint32_t begin, uint32_t end);
+    void updateRun(uint32_t begin, uint32_t end);
+
+    ThreadPool* pool;
+
+    // all indexed by internal index
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> subtreeEnd;
+    TransformSoA local;
+    std::vector<Mat4> localMatrix;
+    std::vector<Mat4> worldMatrix;
+    std::vector<uint64_t> dirty;
+
+    std::vector<uint32_t> handleToIndex;
+    std::vector<uint32_t> indexToHandle;
+
+    // nodes above the split point are updated serially, the subtrees under them in parallel
+    std::vector<uint32_t> serialNodes;
+    std::vector<Range> jobs;
+
+    bool orderDirty = false;
+    size_t updatedCount = 0;
+};
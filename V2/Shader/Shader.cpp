@@ -3,17 +3,29 @@
 #include <sstream>
 #include <iostream>
 
+#include "Debug/Profiler.hpp"
+#include "Debug/DebugOutput.hpp"
+#include "Debug/GLCapture.hpp"
+
 Shader::Shader(const char* vertexPath, const char* fragmentPath) {
+    PROFILE_SCOPE("Shader::compile");
     std::string vSrc = loadFile(vertexPath);
     std::string fSrc = loadFile(fragmentPath);
 
     GLuint v = compile(GL_VERTEX_SHADER, vSrc.c_str());
     GLuint f = compile(GL_FRAGMENT_SHADER, fSrc.c_str());
+    DebugOutput::label(GL_SHADER, v, vertexPath);
+    DebugOutput::label(GL_SHADER, f, fragmentPath);
 
     programID = glCreateProgram();
+#if defined(V2_GL_DEBUG)
+    std::string name = std::string(vertexPath) + " + " + fragmentPath;
+    DebugOutput::label(GL_PROGRAM, programID, name.c_str());
+#endif
     glAttachShader(programID, v);
     glAttachShader(programID, f);
     glLinkProgram(programID);
+    GLCapture::createProgram(programID, vSrc, fSrc);
 
     std::cout << "VERTEX SHADER LOADED:\n" << vSrc << "\n\n";
     std::cout << "FRAGMENT SHADER LOADED:\n" << fSrc << "\n\n";
@@ -34,6 +46,7 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
 
 void Shader::use() const {
     glUseProgram(programID);
+    GLCapture::useProgram(programID);
   //  int loc = glGetUniformLocation(programID, "uTexture");
    // std::cout << "uTexture location = " << loc << "\n";
 }
@@ -56,14 +69,17 @@ GLuint Shader::compile(GLenum type, const char* src) {
 
 void Shader::setFloat(const char* name, const float value) const {
     glUniform1f(glGetUniformLocation(programID, name), value);
+    GLCapture::uniform1f(programID, name, value);
 }
 
 void Shader::setMat4(const char* name, const float* mat) const {
     glUniformMatrix4fv(glGetUniformLocation(programID, name), 1, GL_FALSE, mat);
+    GLCapture::uniformMat4(programID, name, mat);
 }
 
 void Shader::setInt(const char* name, int value) const {
     glUniform1i(glGetUniformLocation(programID, name), value);
+    GLCapture::uniform1i(programID, name, value);
 }
 
 std::string Shader::loadFile(const char* path) {
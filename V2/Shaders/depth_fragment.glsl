@@ -0,0 +1,5 @@
+#version 410 core
+
+// nothing to shade, only depth gets written
+void main() {
+}
@@ -0,0 +1,13 @@
+#version 410 core
+
+// Position only, used by the depth pre-pass and the overdraw view.
+// Has to produce bit-identical depth to vertex_shader.glsl for GL_EQUAL to work.
+layout(location = 0) in vec2 aPos;
+
+uniform mat4 uModel;
+
+invariant gl_Position;
+
+void main() {
+    gl_Position = uModel * vec4(aPos, 0.0, 1.0);
+}
@@ -0,0 +1,8 @@
+#version 410 core
+
+// color writes are masked off while proxies are drawn, only the samples count
+out vec4 FragColor;
+
+void main() {
+    FragColor = vec4(1.0);
+}
@@ -0,0 +1,10 @@
+#version 410 core
+
+layout(location = 0) in vec3 aPos;
+
+// unit cube [-1, 1] -> world space box -> clip space
+uniform mat4 uMVP;
+
+void main() {
+    gl_Position = uMVP * vec4(aPos, 1.0);
+}
@@ -0,0 +1,9 @@
+#version 410 core
+
+// Blended additively, so every fragment that reaches the shader brightens the pixel a bit.
+// Black = nothing shaded, white = 10 or more layers.
+out vec4 FragColor;
+
+void main() {
+    FragColor = vec4(0.1, 0.1, 0.1, 1.0);
+}
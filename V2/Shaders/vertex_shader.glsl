@@ -9,6 +9,9 @@ out vec2 vUV;
 
 uniform mat4 uModel;
 
+// must match depth_vertex.glsl exactly for the pre-pass GL_EQUAL test
+invariant gl_Position;
+
 void main() {
     gl_Position = uModel * vec4(aPos, 0.0, 1.0);
     vColor = aColor;
@@ -0,0 +1,455 @@
+// Replays a capture written by GLCapture (Debug/GLCapture.hpp) and reports per-call and
+// per-frame timing, so a fixed workload can be compared across commits.
+// Built by the GLReplay target in V2/CMakeLists.txt:
+//   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release && cmake --build build --target GLReplay
+//   GLReplay capture.v2cap [--loops n] [--headless] [--json results.json]
+#define SDL_MAIN_HANDLED
+#include <SDL_2/SDL.h>
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Window/Window.hpp"
+#include "Debug/CaptureFormat.hpp"
+
+using CaptureFormat::Op;
+using Clock = std::chrono::steady_clock;
+
+struct Record {
+    Op op;
+    const uint8_t* data;
+    uint32_t size;
+};
+
+struct FrameRange {
+    uint32_t frame;
+    size_t begin; // record indices, the previous EndFrame (exclusive) .. EndFrame inclusive
+    size_t end;
+};
+
+template<typename T>
+static T read(const uint8_t* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+static bool parse(const std::vector<uint8_t>& file, std::vector<Record>& records) {
+    if (file.size() < sizeof(CaptureFormat::Header)) return false;
+    CaptureFormat::Header header = read<CaptureFormat::Header>(file.data());
+    if (std::memcmp(header.magic, CaptureFormat::kMagic, 4) != 0 || header.version != CaptureFormat::kVersion) {
+        return false;
+    }
+
+    size_t pos = sizeof(header);
+    while (pos + 5 <= file.size()) {
+        Record r;
+        r.op = static_cast<Op>(file[pos]);
+        r.size = read<uint32_t>(file.data() + pos + 1);
+        r.data = file.data() + pos + 5;
+        pos += 5 + r.size;
+        if (pos > file.size() || r.op == Op::Count) {
+            return false; // truncated, the app probably died mid capture
+        }
+        records.push_back(r);
+    }
+    return true;
+}
+
+// Setup records run once as captured. Frame records are looped, so the objects they create
+// are made once by prepare() and a Create / Delete inside a frame only changes which object
+// an id maps to; every loop then replays the same workload on the same objects, and what the
+// frames delete is released by releaseRetired() after the last loop.
+class Replayer {
+public:
+    void execute(const Record& r);
+    void prepare(const Record& r);
+
+    // The frames start from the ids as setup left them, whatever the last loop deleted
+    void saveSetupIds() { setupIds = ids; }
+    void restoreSetupIds() { ids = setupIds; }
+    void releaseRetired();
+
+    struct OpTiming {
+        uint64_t count = 0;
+        double totalUs = 0.0;
+    };
+    OpTiming timings[static_cast<size_t>(Op::Count)];
+
+    void executeTimed(const Record& r) {
+        Clock::time_point start = Clock::now();
+        execute(r);
+        OpTiming& t = timings[static_cast<size_t>(r.op)];
+        t.count++;
+        t.totalUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+private:
+    using IdMap = std::unordered_map<uint32_t, GLuint>;
+    struct Ids {
+        IdMap buffers, vaos, textures, programs;
+    };
+
+    GLuint create(const Record& r);
+    void remove(IdMap& objects, uint32_t id, Op op);
+    void useProgram(GLuint program);
+    GLint location(GLuint program, const char* name, size_t length);
+    template<typename Set>
+    void uniform(const Record& r, size_t nameOffset, Set set);
+
+    Ids ids, setupIds;
+    std::unordered_map<const uint8_t*, GLuint> prepared; // frame Create records, by payload
+    std::vector<std::pair<Op, GLuint>> retired;
+    std::map<std::pair<GLuint, std::string>, GLint> locations;
+    GLuint currentProgram = 0;
+};
+
+GLint Replayer::location(GLuint program, const char* name, size_t length) {
+    auto key = std::make_pair(program, std::string(name, length));
+    auto it = locations.find(key);
+    if (it != locations.end()) return it->second;
+    GLint loc = glGetUniformLocation(program, key.second.c_str());
+    locations.emplace(key, loc);
+    return loc;
+}
+
+void Replayer::useProgram(GLuint program) {
+    if (program != currentProgram) {
+        currentProgram = program;
+        glUseProgram(program);
+    }
+}
+
+// Uniform records carry the program they were set on, which need not be the one in use
+// (a freshly linked material), so it is made current for the call and switched back after
+template<typename Set>
+void Replayer::uniform(const Record& r, size_t nameOffset, Set set) {
+    GLuint program = ids.programs[read<uint32_t>(r.data)];
+    GLuint previous = currentProgram;
+    useProgram(program);
+    set(location(program, reinterpret_cast<const char*>(r.data + nameOffset), r.size - nameOffset));
+    useProgram(previous);
+}
+
+GLuint Replayer::create(const Record& r) {
+    const uint8_t* p = r.data;
+    switch (r.op) {
+    case Op::CreateBuffer: {
+        GLuint b = 0;
+        glGenBuffers(1, &b);
+        glBindBuffer(GL_ARRAY_BUFFER, b);
+        glBufferData(GL_ARRAY_BUFFER, r.size - 4, r.size > 4 ? p + 4 : nullptr, GL_STATIC_DRAW);
+        return b;
+    }
+    case Op::CreateVertexArray: {
+        GLuint v = 0;
+        glGenVertexArrays(1, &v);
+        return v;
+    }
+    case Op::CreateTexture: {
+        GLuint t = 0;
+        glGenTextures(1, &t);
+        glBindTexture(GL_TEXTURE_2D, t);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        int32_t w = read<int32_t>(p + 4), h = read<int32_t>(p + 8);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, r.size > 12 ? p + 12 : nullptr);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        return t;
+    }
+    case Op::CreateProgram: {
+        uint32_t vLen = read<uint32_t>(p + 4);
+        std::string vSrc(reinterpret_cast<const char*>(p + 8), vLen);
+        std::string fSrc(reinterpret_cast<const char*>(p + 8 + vLen), r.size - 8 - vLen);
+        const char* srcs[2] = { vSrc.c_str(), fSrc.c_str() };
+        GLenum types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+
+        GLuint program = glCreateProgram();
+        for (int i = 0; i < 2; i++) {
+            GLuint s = glCreateShader(types[i]);
+            glShaderSource(s, 1, &srcs[i], nullptr);
+            glCompileShader(s);
+            glAttachShader(program, s);
+            glDeleteShader(s);
+        }
+        glLinkProgram(program);
+        return program;
+    }
+    default:
+        return 0;
+    }
+}
+
+void Replayer::prepare(const Record& r) {
+    switch (r.op) {
+    case Op::CreateBuffer:
+    case Op::CreateVertexArray:
+    case Op::CreateTexture:
+    case Op::CreateProgram:
+        prepared[r.data] = create(r);
+        break;
+    default:
+        break;
+    }
+}
+
+// Drops the mapping for a deleted id, the app may get the same id back for a new object.
+// Objects the frames use are only deleted once looping is over.
+void Replayer::remove(IdMap& objects, uint32_t id, Op op) {
+    auto it = objects.find(id);
+    if (it == objects.end()) return;
+    GLuint object = it->second;
+    objects.erase(it);
+    if (std::find(retired.begin(), retired.end(), std::make_pair(op, object)) == retired.end()) {
+        retired.emplace_back(op, object);
+    }
+}
+
+void Replayer::releaseRetired() {
+    for (auto& [op, object] : retired) {
+        switch (op) {
+        case Op::DeleteBuffer:      glDeleteBuffers(1, &object); break;
+        case Op::DeleteVertexArray: glDeleteVertexArrays(1, &object); break;
+        case Op::DeleteTexture:     glDeleteTextures(1, &object); break;
+        default: break;
+        }
+    }
+    retired.clear();
+}
+
+void Replayer::execute(const Record& r) {
+    const uint8_t* p = r.data;
+    switch (r.op) {
+    case Op::CreateBuffer:
+    case Op::CreateVertexArray:
+    case Op::CreateTexture:
+    case Op::CreateProgram: {
+        IdMap& objects = r.op == Op::CreateBuffer ? ids.buffers :
+                         r.op == Op::CreateVertexArray ? ids.vaos :
+                         r.op == Op::CreateTexture ? ids.textures : ids.programs;
+        auto it = prepared.find(p);
+        objects[read<uint32_t>(p)] = it != prepared.end() ? it->second : create(r);
+        break;
+    }
+    case Op::VertexAttrib: {
+        auto a = read<CaptureFormat::VertexAttribRecord>(p);
+        glBindVertexArray(ids.vaos[a.vao]);
+        glBindBuffer(GL_ARRAY_BUFFER, ids.buffers[a.vbo]);
+        glEnableVertexAttribArray(a.index);
+        glVertexAttribPointer(a.index, a.count, a.type, static_cast<GLboolean>(a.normalized), a.stride,
+                              reinterpret_cast<const void*>(static_cast<uintptr_t>(a.offset)));
+        glBindVertexArray(0);
+        break;
+    }
+    case Op::DeleteBuffer:
+        remove(ids.buffers, read<uint32_t>(p), r.op);
+        break;
+    case Op::DeleteVertexArray:
+        remove(ids.vaos, read<uint32_t>(p), r.op);
+        break;
+    case Op::DeleteTexture:
+        remove(ids.textures, read<uint32_t>(p), r.op);
+        break;
+    case Op::UseProgram:
+        useProgram(ids.programs[read<uint32_t>(p)]);
+        break;
+    case Op::Uniform1i:
+        uniform(r, 8, [p](GLint loc) { glUniform1i(loc, read<int32_t>(p + 4)); });
+        break;
+    case Op::Uniform1f:
+        uniform(r, 8, [p](GLint loc) { glUniform1f(loc, read<float>(p + 4)); });
+        break;
+    case Op::UniformMat4: {
+        float m[16];
+        std::memcpy(m, p + 4, sizeof(m));
+        uniform(r, 4 + sizeof(m), [&m](GLint loc) { glUniformMatrix4fv(loc, 1, GL_FALSE, m); });
+        break;
+    }
+    case Op::BindTexture:
+        glActiveTexture(GL_TEXTURE0 + read<uint32_t>(p));
+        glBindTexture(GL_TEXTURE_2D, ids.textures[read<uint32_t>(p + 4)]);
+        break;
+    case Op::BindVertexArray:
+        glBindVertexArray(ids.vaos[read<uint32_t>(p)]);
+        break;
+    case Op::Clear: {
+        float c[4];
+        std::memcpy(c, p + 4, sizeof(c));
+        glClearColor(c[0], c[1], c[2], c[3]);
+        glClear(read<uint32_t>(p));
+        break;
+    }
+    case Op::DrawArrays: {
+        auto d = read<CaptureFormat::DrawRecord>(p);
+        if (d.depthTest) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+        if (d.blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
+        glDepthMask(d.depthMask ? GL_TRUE : GL_FALSE);
+        glDepthFunc(d.depthFunc);
+        glBlendFunc(d.blendSrc, d.blendDst);
+        glColorMask(d.colorMask & 1, (d.colorMask >> 1) & 1, (d.colorMask >> 2) & 1, (d.colorMask >> 3) & 1);
+        glDrawArrays(d.mode, d.first, d.count);
+        break;
+    }
+    case Op::BeginFrame:
+    case Op::EndFrame:
+    default:
+        break;
+    }
+}
+
+struct Spread {
+    double min = 0.0, median = 0.0, p95 = 0.0;
+};
+
+static Spread spread(std::vector<double> v) {
+    Spread s;
+    if (v.empty()) return s;
+    std::sort(v.begin(), v.end());
+    s.min = v.front();
+    s.median = v[v.size() / 2];
+    s.p95 = v[std::min(v.size() - 1, static_cast<size_t>(v.size() * 0.95))];
+    return s;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: GLReplay capture.v2cap [--loops n] [--headless] [--json results.json]\n";
+        return 1;
+    }
+    const char* path = argv[1];
+    int loops = 100;
+    bool headless = false;
+    const char* jsonPath = nullptr;
+    for (int i = 2; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--loops") && i + 1 < argc) loops = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--headless")) headless = true;
+        else if (!std::strcmp(argv[i], "--json") && i + 1 < argc) jsonPath = argv[++i];
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::vector<Record> records;
+    if (!parse(file, records)) {
+        std::cerr << "Not a valid capture: " << path << "\n";
+        return 1;
+    }
+
+    // resources first, then the frames that get looped. What was recorded between two
+    // frames (creates and deletes) runs at the start of the next one.
+    size_t setupEnd = records.size();
+    std::vector<FrameRange> frames;
+    for (size_t i = 0; i < records.size(); i++) {
+        if (records[i].op == Op::BeginFrame) {
+            setupEnd = std::min(setupEnd, i);
+            size_t begin = frames.empty() ? i : frames.back().end + 1;
+            frames.push_back({ read<uint32_t>(records[i].data), begin, records.size() - 1 });
+        } else if (records[i].op == Op::EndFrame && !frames.empty()) {
+            frames.back().end = i;
+        }
+    }
+    if (frames.empty()) {
+        std::cerr << "Capture has no frames\n";
+        return 1;
+    }
+
+    GLint viewport[4];
+    std::memcpy(viewport, records[frames[0].begin].data + 4, sizeof(viewport));
+
+    WindowSettings settings;
+    settings.headless = headless;
+    settings.swapInterval = SwapInterval::Immediate;
+    Window window(std::max(viewport[2], 1), std::max(viewport[3], 1), "GLReplay", settings);
+
+    Replayer replayer;
+    for (size_t i = 0; i < setupEnd; i++) {
+        replayer.execute(records[i]);
+    }
+    replayer.saveSetupIds();
+    for (size_t i = setupEnd; i < records.size(); i++) {
+        replayer.prepare(records[i]);
+    }
+    glFinish();
+
+    std::vector<GLuint> queries(static_cast<size_t>(loops) * frames.size());
+    glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+    std::vector<std::vector<double>> cpuMs(frames.size());
+
+    for (int loop = 0; loop < loops && !window.shouldClose(); loop++) {
+        replayer.restoreSetupIds();
+        for (size_t f = 0; f < frames.size(); f++) {
+            window.pollEvents();
+            Clock::time_point start = Clock::now();
+            glBeginQuery(GL_TIME_ELAPSED, queries[loop * frames.size() + f]);
+            for (size_t i = frames[f].begin; i <= frames[f].end; i++) {
+                replayer.executeTimed(records[i]);
+            }
+            glEndQuery(GL_TIME_ELAPSED);
+            cpuMs[f].push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            window.swapBuffers();
+        }
+    }
+    replayer.releaseRetired();
+    glFinish();
+
+    std::vector<std::vector<double>> gpuMs(frames.size());
+    for (size_t f = 0; f < frames.size(); f++) {
+        for (size_t loop = 0; loop < cpuMs[f].size(); loop++) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(queries[loop * frames.size() + f], GL_QUERY_RESULT, &ns);
+            gpuMs[f].push_back(ns / 1.0e6);
+        }
+    }
+    glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+
+    std::printf("%-18s %10s %12s %10s\n", "call", "count", "total ms", "avg us");
+    for (size_t op = 0; op < static_cast<size_t>(Op::Count); op++) {
+        const Replayer::OpTiming& t = replayer.timings[op];
+        if (!t.count) continue;
+        std::printf("%-18s %10llu %12.3f %10.3f\n", CaptureFormat::opName(static_cast<Op>(op)),
+                    static_cast<unsigned long long>(t.count), t.totalUs / 1000.0, t.totalUs / t.count);
+    }
+    std::printf("\n%-8s %28s %28s\n", "frame", "cpu ms (min/median/p95)", "gpu ms (min/median/p95)");
+    for (size_t f = 0; f < frames.size(); f++) {
+        Spread c = spread(cpuMs[f]), g = spread(gpuMs[f]);
+        std::printf("%-8u %8.3f %8.3f %8.3f    %8.3f %8.3f %8.3f\n", frames[f].frame,
+                    c.min, c.median, c.p95, g.min, g.median, g.p95);
+    }
+
+    if (jsonPath) {
+        FILE* out = std::fopen(jsonPath, "w");
+        if (!out) {
+            std::cerr << "Could not write " << jsonPath << "\n";
+            return 1;
+        }
+        std::fprintf(out, "{\n  \"capture\": \"%s\",\n  \"loops\": %d,\n  \"renderer\": \"%s\",\n  \"calls\": [",
+                     path, loops, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+        bool firstEntry = true;
+        for (size_t op = 0; op < static_cast<size_t>(Op::Count); op++) {
+            const Replayer::OpTiming& t = replayer.timings[op];
+            if (!t.count) continue;
+            std::fprintf(out, "%s\n    {\"name\": \"%s\", \"count\": %llu, \"totalMs\": %.6f, \"avgUs\": %.6f}",
+                         firstEntry ? "" : ",", CaptureFormat::opName(static_cast<Op>(op)),
+                         static_cast<unsigned long long>(t.count), t.totalUs / 1000.0, t.totalUs / t.count);
+            firstEntry = false;
+        }
+        std::fprintf(out, "\n  ],\n  \"frames\": [");
+        for (size_t f = 0; f < frames.size(); f++) {
+            std::fprintf(out, "%s\n    {\"frame\": %u, \"cpuMs\": [", f ? "," : "", frames[f].frame);
+            for (size_t i = 0; i < cpuMs[f].size(); i++) std::fprintf(out, "%s%.6f", i ? ", " : "", cpuMs[f][i]);
+            std::fprintf(out, "], \"gpuMs\": [");
+            for (size_t i = 0; i < gpuMs[f].size(); i++) std::fprintf(out, "%s%.6f", i ? ", " : "", gpuMs[f][i]);
+            std::fprintf(out, "]}");
+        }
+        std::fprintf(out, "\n  ]\n}\n");
+        std::fclose(out);
+    }
+    return 0;
+}
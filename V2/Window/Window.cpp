@@ -1,8 +1,21 @@
 #include "Window.hpp"
 #include <glad/glad.h>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 
-Window::Window(int width, int height, const std::string& title) {
+#include "Debug/DebugOutput.hpp"
+
+Window::Window(int width, int height, const std::string& title, const WindowSettings& settings)
+    : width(width), height(height)
+{
+#if !defined(_WIN32)
+    // no X11 / Wayland to talk to, SDL's offscreen driver gets a context through EGL
+    if (settings.headless && !std::getenv("DISPLAY") && !std::getenv("WAYLAND_DISPLAY")) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+    }
+#endif
+
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         std::cerr << "SDL_INIT error: " << SDL_GetError() << "\n";
         exit(1);
@@ -11,12 +24,18 @@ Window::Window(int width, int height, const std::string& title) {
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, settings.depthBits);
+    SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, settings.stencilBits);
+#if defined(V2_GL_DEBUG)
+    // most drivers only produce debug messages for debug contexts
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG);
+#endif
 
     window = SDL_CreateWindow(
         title.c_str(),
         SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
         width, height,
-        SDL_WINDOW_OPENGL
+        settings.headless ? SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN : SDL_WINDOW_OPENGL
     );
 
     if (!window) {
@@ -34,26 +53,195 @@ Window::Window(int width, int height, const std::string& title) {
         std::cerr << "Failed to initialize GLAD!\n";
         exit(1);
     }
+    DebugOutput::init();
+
+    if (settings.headless) {
+        createOffscreenTarget(settings);
+    } else {
+        // the driver may hand out fewer bits than asked for (or none)
+        SDL_GL_GetAttribute(SDL_GL_DEPTH_SIZE, &depthBits);
+        setSwapInterval(settings.swapInterval);
+    }
+
+    if (depthBits > 0) {
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+    }
+}
+
+void Window::createOffscreenTarget(const WindowSettings& settings) {
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+
+    if (settings.depthBits > 0) {
+        GLenum format = settings.stencilBits > 0 ? GL_DEPTH24_STENCIL8 : GL_DEPTH_COMPONENT24;
+        GLenum attachment = settings.stencilBits > 0 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, format, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, depthBuffer);
+        depthBits = 24;
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Offscreen framebuffer incomplete\n";
+        exit(1);
+    }
+
+    // stays bound for the lifetime of the window, nothing else binds framebuffers
+    glViewport(0, 0, width, height);
+}
+
+SwapInterval Window::setSwapInterval(SwapInterval interval) {
+    if (SDL_GL_SetSwapInterval(static_cast<int>(interval)) != 0) {
+        if (interval == SwapInterval::Adaptive) {
+            std::cerr << "Adaptive vsync not supported, using vsync: " << SDL_GetError() << "\n";
+            return setSwapInterval(SwapInterval::VSync);
+        }
+        std::cerr << "SDL_GL_SetSwapInterval failed: " << SDL_GetError() << "\n";
+        interval = static_cast<SwapInterval>(SDL_GL_GetSwapInterval());
+    }
+    swapInterval = interval;
+    return swapInterval;
+}
+
+void Window::handleEvent(const SDL_Event& e) {
+    if (e.type == SDL_QUIT) {
+        closeRequested = true;
+    } else if (e.type == SDL_KEYDOWN) {
+        pressedKeys.push_back(e.key.keysym.sym);
+    } else if (e.type == SDL_WINDOWEVENT) {
+        switch (e.window.event) {
+        case SDL_WINDOWEVENT_FOCUS_GAINED: focused = true; break;
+        case SDL_WINDOWEVENT_FOCUS_LOST:   focused = false; break;
+        case SDL_WINDOWEVENT_MINIMIZED:    minimized = true; break;
+        case SDL_WINDOWEVENT_RESTORED:
+        case SDL_WINDOWEVENT_MAXIMIZED:
+            minimized = false;
+            invalidated = true;
+            break;
+        case SDL_WINDOWEVENT_SHOWN:
+        case SDL_WINDOWEVENT_EXPOSED:
+        case SDL_WINDOWEVENT_SIZE_CHANGED:
+            invalidated = true;
+            break;
+        default: break;
+        }
+    }
 }
 
 void Window::pollEvents() {
+    pressedKeys.clear();
     SDL_Event e;
     while (SDL_PollEvent(&e)) {
-        if (e.type == SDL_QUIT) {
-            closeRequested = true;
+        handleEvent(e);
+    }
+}
+
+void Window::waitEvents(int timeoutMs) {
+    if (timeoutMs <= 0) {
+        pollEvents();
+        return;
+    }
+    pressedKeys.clear();
+    SDL_Event e;
+    if (SDL_WaitEventTimeout(&e, timeoutMs)) {
+        handleEvent(e);
+        while (SDL_PollEvent(&e)) {
+            handleEvent(e);
         }
     }
 }
 
+bool Window::takeInvalidated() {
+    bool was = invalidated;
+    invalidated = false;
+    return was;
+}
+
+bool Window::wasKeyPressed(SDL_Keycode key) const {
+    for (SDL_Keycode k : pressedKeys) {
+        if (k == key) return true;
+    }
+    return false;
+}
+
 void Window::swapBuffers() const {
+    if (fbo) {
+        // nothing to present, just make sure the frame actually gets executed
+        glFlush();
+        return;
+    }
     SDL_GL_SwapWindow(window);
 }
 
+void Window::makeCurrent() const {
+    if (SDL_GL_MakeCurrent(window, glContext) != 0) {
+        std::cerr << "SDL_GL_MakeCurrent failed: " << SDL_GetError() << "\n";
+    }
+}
+
+void Window::releaseCurrent() const {
+    SDL_GL_MakeCurrent(window, nullptr);
+}
+
+SDL_GLContext Window::createSharedContext() const {
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    SDL_GLContext shared = SDL_GL_CreateContext(window); // and makes it current
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    if (!shared) {
+        std::cerr << "Shared context creation failed: " << SDL_GetError() << "\n";
+    }
+    makeCurrent();
+    return shared;
+}
+
+void Window::readPixels(std::vector<unsigned char>& rgba) const {
+    rgba.resize(static_cast<size_t>(width) * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    if (!fbo) {
+        glReadBuffer(GL_BACK);
+    }
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+}
+
+bool Window::captureFrame(const std::string& path) const {
+    std::vector<unsigned char> rgba;
+    readPixels(rgba);
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Could not write " << path << "\n";
+        return false;
+    }
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    // GL rows start at the bottom, PPM rows at the top
+    for (int y = height - 1; y >= 0; y--) {
+        const unsigned char* row = rgba.data() + static_cast<size_t>(y) * width * 4;
+        for (int x = 0; x < width; x++) {
+            std::fwrite(row + x * 4, 1, 3, file);
+        }
+    }
+    std::fclose(file);
+    return true;
+}
+
 bool Window::shouldClose() const {
     return closeRequested;
 }
 
 Window::~Window() {
+    if (fbo) {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+    }
     SDL_GL_DeleteContext(glContext);
     SDL_DestroyWindow(window);
     SDL_Quit();
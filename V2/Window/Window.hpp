@@ -2,19 +2,82 @@
 
 #include <SDL_2/SDL.h>
 #include <string>
+#include <vector>
+
+enum class SwapInterval {
+    Immediate = 0,
+    VSync = 1,
+    Adaptive = -1 // vsync, but late frames swap right away instead of waiting another refresh
+};
+
+struct WindowSettings {
+    int depthBits = 24;   // 0 = no depth attachment
+    int stencilBits = 0;
+    SwapInterval swapInterval = SwapInterval::VSync;
+    // Hidden window, everything renders into an offscreen framebuffer instead of the
+    // window's back buffer. For machines without a display (Mesa llvmpipe is fine).
+    bool headless = false;
+};
 
 class Window {
 public:
-    Window(int width, int height, const std::string& title);
+    Window(int width, int height, const std::string& title, const WindowSettings& settings = {});
     ~Window();
 
     bool shouldClose() const;
     void pollEvents();
+    // Blocks until an event arrives or timeoutMs passes (0 = just poll), then drains the queue
+    void waitEvents(int timeoutMs);
     void swapBuffers() const;
 
+    // Moves the GL context between threads (RenderThread), it is current on the creating thread at first
+    void makeCurrent() const;
+    void releaseCurrent() const;
+    // Second context sharing objects with this one, for a loader thread. Needs this window's
+    // context current and leaves it current, nullptr if the driver won't share.
+    SDL_GLContext createSharedContext() const;
+
+    // Falls back to plain vsync when adaptive is not supported, returns what was set
+    SwapInterval setSwapInterval(SwapInterval interval);
+    SwapInterval getSwapInterval() const { return swapInterval; }
+
+    // Something happened that changes what is on screen (expose, resize, restore, ...).
+    // Reading it clears it.
+    bool takeInvalidated();
+    bool isFocused() const { return focused; }
+    bool isMinimized() const { return minimized; }
+    bool wasKeyPressed(SDL_Keycode key) const;
+
+    bool isHeadless() const { return fbo != 0; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // Reads the current frame back as tightly packed RGBA8, bottom row first
+    void readPixels(std::vector<unsigned char>& rgba) const;
+    // Binary PPM, so there is no image library dependency
+    bool captureFrame(const std::string& path) const;
+
     SDL_Window* getSDLWindow() const { return window; }
+    bool hasDepth() const { return depthBits > 0; }
 private:
+    void handleEvent(const SDL_Event& e);
+    void createOffscreenTarget(const WindowSettings& settings);
+
+    int width = 0;
+    int height = 0;
+
     SDL_Window *window = nullptr;
     SDL_GLContext glContext = nullptr;
     bool closeRequested = false;
+    int depthBits = 0;
+    bool invalidated = true;
+    bool focused = true;
+    bool minimized = false;
+    std::vector<SDL_Keycode> pressedKeys; // since the last poll/wait
+    SwapInterval swapInterval = SwapInterval::VSync;
+
+    // headless only
+    unsigned int fbo = 0;
+    unsigned int colorBuffer = 0;
+    unsigned int depthBuffer = 0;
 };
\ No newline at end of file
@@ -1,8 +1,12 @@
 #define SDL_MAIN_HANDLED
 #include <SDL_2/SDL.h>
 #include <glad/glad.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
-#include <direct.h>
 
 #include "Shader/Shader.hpp"
 #include "Window/Window.hpp"
@@ -12,6 +16,20 @@
 #include "Renderer/VertexLayout.hpp"
 #include "Renderer/VertexBuffer.hpp"
 #include "Renderer/Texture.hpp"
+#include "Renderer/OcclusionCuller.hpp"
+#include "Renderer/DepthPrepass.hpp"
+#include "Renderer/GpuTimer.hpp"
+#include "Renderer/RenderThread.hpp"
+#include "Renderer/ResourceLoader.hpp"
+
+#include "Core/FrameClock.hpp"
+#include "Core/FrameScheduler.hpp"
+#include "Debug/Profiler.hpp"
+#include "Debug/DebugOutput.hpp"
+#include "Debug/GLCapture.hpp"
+#include "Math/Math.hpp"
+#include "Scene/TransformHierarchy.hpp"
+#include "Scene/FrustumCuller.hpp"
 
 void getOpenGLversionDetails() {
     std::cout << "Vendor Version:           " << glGetString(GL_VENDOR) << "\n";
@@ -21,11 +39,27 @@ void getOpenGLversionDetails() {
 }
 
 int main() {
-    char buffer[512];
-    _getcwd(buffer, 512);
-    std::cout << "Working dir = " << buffer << "\n";
+    std::cout << "Working dir = " << std::filesystem::current_path().string() << "\n";
+
+    // V2_HEADLESS_FRAMES=n renders n frames offscreen, writes capture.ppm and exits
+    const char* headlessFrames = std::getenv("V2_HEADLESS_FRAMES");
+    unsigned long framesLeft = headlessFrames ? std::strtoul(headlessFrames, nullptr, 10) : 0;
+
+    // V2_CAPTURE=file records frames [V2_CAPTURE_FIRST, + V2_CAPTURE_COUNT) for Tools/GLReplay,
+    // it has to start before the first GL object is created
+    if (const char* capturePath = std::getenv("V2_CAPTURE")) {
+        const char* first = std::getenv("V2_CAPTURE_FIRST");
+        const char* count = std::getenv("V2_CAPTURE_COUNT");
+        GLCapture::start(capturePath,
+                         first ? std::strtoul(first, nullptr, 10) : 60,
+                         count ? std::strtoul(count, nullptr, 10) : 1);
+    }
 
-    Window window(800, 600, "Modular OpenGL");
+    WindowSettings settings;
+    settings.swapInterval = SwapInterval::Adaptive;
+    settings.headless = headlessFrames != nullptr;
+    Window window(800, 600, "Modular OpenGL", settings);
+    Profiler::get().initGpu();
 
     Shader shader(
         "Shaders/vertex_shader.glsl",
@@ -33,8 +67,7 @@ int main() {
     );
 
     shader.use();
-    GLenum err = glGetError();
-    std::cout << "shader error: " << err << "\n";
+    DebugOutput::drain(std::cerr);
 /*
     float model[] = {
         1, 0, 0, 0,
@@ -44,7 +77,10 @@ int main() {
     };
 */
 
+    // simulation state, advanced in fixed steps and interpolated for drawing
+    const float spinSpeed = 0.6f; // radians per second
     float angle = 0.0f;
+    float previousAngle = 0.0f;
 
 
     float vertices[] = {
@@ -59,42 +95,220 @@ int main() {
     layout.push<float>(3); // color
     layout.push<float>(2); // uv
 
-    Texture tex("Textures/bright-squares.png");
-
+    // decoded and uploaded on the loader's own context, drawn untextured until it's there
+    ResourceLoader loader(window);
+    TextureUpload tex = loader.loadTexture("Textures/bright-squares.png");
 
     shader.use();
-    tex.bind(0); 
     shader.setInt("uTexture", 0);
 
     Mesh triangle(vertices, 21, layout);
 
+    TransformHierarchy scene;
+    TransformHierarchy::Handle triangleNode = scene.create();
+
+    // no camera yet, so the frustum is just the clip space cube
+    Mat4 viewProj = Mat4::identity();
+    Vec3 eye(0.0f, 0.0f, -1.0f);
+    Frustum frustum = Frustum::fromMatrix(viewProj);
+    FrustumCuller culler;
+    uint32_t triangleCullIndex = culler.add(triangle.getBounds());
+
+    OcclusionCuller occlusion(
+        "Shaders/occlusion_vertex.glsl",
+        "Shaders/occlusion_fragment.glsl"
+    );
+    uint32_t triangleOcclusion = occlusion.addObject();
+
+    DepthPrepass prepass(
+        "Shaders/depth_vertex.glsl",
+        "Shaders/depth_fragment.glsl",
+        "Shaders/overdraw_fragment.glsl"
+    );
+    prepass.enabled = window.hasDepth();
+    std::vector<uint32_t> visible;
+    FrameClock clock;
+
+    // only redraw when something changed, space toggles the animation, o the overdraw view,
+    // p writes the profile so far to profile.json (chrome://tracing)
+    FrameScheduler scheduler;
+    GpuTimer gpuTimer;
+    bool animate = true;
+    bool showOverdraw = false;
+    scheduler.setContinuous(animate);
+    FrameClock::Clock::time_point lastReport = FrameClock::Clock::now();
+
     getOpenGLversionDetails();
 
+    // From here on GL belongs to the render thread: this thread handles input, simulates and
+    // records commands, everything that calls GL itself goes through cmd.call().
+    // V2_RENDER_THREAD=0 runs the same commands inline, for comparing the two.
+    const char* renderThreadEnv = std::getenv("V2_RENDER_THREAD");
+    RenderThread renderer(window, !(renderThreadEnv && std::strcmp(renderThreadEnv, "0") == 0));
+    std::atomic<int64_t> gpuMicros{ 0 }; // written by the render thread, taken by the report
+    constexpr int kLoaderPollMs = 16;
+
     while (!window.shouldClose()) {
-        window.pollEvents();
-        glClearColor(0, 0, 0, 1);
-        glClear(GL_COLOR_BUFFER_BIT);
+        // finished uploads are picked up by loader.poll() inside a frame, so while any are
+        // pending an idle loop still renders every kLoaderPollMs instead of waiting for input
+        bool loading = loader.hasPending();
+        int waitMs = scheduler.waitTimeoutMs();
+        window.waitEvents(loading ? std::min(waitMs, kLoaderPollMs) : waitMs);
+        if (loading) {
+            scheduler.invalidate();
+        }
+        FrameClock::Clock::time_point inputTime = FrameClock::Clock::now();
+
+        if (window.wasKeyPressed(SDLK_SPACE)) {
+            animate = !animate;
+            scheduler.setContinuous(animate);
+        }
+        if (window.wasKeyPressed(SDLK_o)) {
+            showOverdraw = !showOverdraw;
+            scheduler.invalidate();
+        }
+        if (window.takeInvalidated()) {
+            scheduler.invalidate();
+        }
+        scheduler.setFocused(window.isFocused());
+        scheduler.setMinimized(window.isMinimized());
+
+        bool report = FrameClock::Clock::now() - lastReport > std::chrono::seconds(5);
+        if (report) {
+            lastReport = FrameClock::Clock::now();
+            scheduler.addGpuTime(gpuMicros.exchange(0) / 1000.0);
+            Utilization u = scheduler.takeUtilization();
+            std::cout << (animate ? "active" : "idle") << ": " << u.fps << " fps, cpu "
+                      << u.cpuBusyPercent << "% gpu " << u.gpuBusyPercent << "%, "
+                      << u.wakeups << " wakeups\n";
+            report = u.frames > 0;
+            if (report) {
+                const CullStats& cs = culler.stats();
+                std::cout << "cull: " << cs.visible << " visible, " << cs.culled << " culled, "
+                          << cs.cullMs << " ms\n";
+                clock.print(std::cout);
+                renderer.printStats(std::cout);
+                renderer.resetStats();
+                loader.printStats(std::cout);
+            }
+        }
+
+        if (!scheduler.beginFrame()) {
+            continue;
+        }
+        if (scheduler.resumedFromIdle()) {
+            clock.resync();
+        }
+        clock.beginFrame();
+
+        while (clock.step()) {
+            previousAngle = angle;
+            if (animate) {
+                angle += spinSpeed * static_cast<float>(clock.fixedStep());
+            }
+        }
+        float drawAngle = previousAngle + (angle - previousAngle) * clock.alpha();
+
+        scene.setRotation(triangleNode, Quat::fromAxisAngle({ 0.0f, 0.0f, 1.0f }, drawAngle));
+        scene.update();
+
+        culler.set(triangleCullIndex, triangle.getBounds().transformed(scene.world(triangleNode)));
+        culler.cull(frustum, visible);
+
+        RenderCommandList& cmd = renderer.beginFrame();
+        cmd.inputTime = inputTime;
+
+        bool writeProfile = window.wasKeyPressed(SDLK_p);
+        cmd.call([&, report, writeProfile, showOverdraw] {
+            // GPU side stats live on the render thread, so they are printed from there
+            if (report) {
+                const OcclusionStats& os = occlusion.stats();
+                std::cout << "occlusion: " << os.occludedDraws << " occluded draws, " << os.queriesInFlight
+                          << " queries in flight, latency " << os.avgLatencyFrames << " frames / "
+                          << os.avgLatencyMs << " ms\n";
+                std::cout << "fragments shaded: " << prepass.fragmentsShaded()
+                          << (prepass.enabled ? " (depth pre-pass on)\n" : " (depth pre-pass off)\n");
+                Profiler::get().printSummary(std::cout);
+                Profiler::get().resetSummary();
+            }
+            if (writeProfile) {
+                Profiler::get().writeChromeTrace("profile.json");
+            }
+            prepass.showOverdraw = showOverdraw;
+            loader.poll();
+
+            Profiler::get().beginFrame();
+            GLCapture::beginFrame();
+            occlusion.beginFrame();
+            gpuTimer.begin();
+        });
+        cmd.clear(window.hasDepth() ? GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT : GL_COLOR_BUFFER_BIT, 0, 0, 0, 1);
+
+        if (!visible.empty()) {
+            const Mat4& model = scene.world(triangleNode);
+
+            // opaque geometry into the depth buffer first, the queries below test against it too
+            cmd.call([&] { prepass.beginDepthPass(); });
+            if (prepass.enabled) {
+                cmd.setMat4(prepass.depthShader(), "uModel", model.data());
+                cmd.draw(triangle);
+            }
+            cmd.call([&] { prepass.endDepthPass(); });
 
-        shader.use();
+            AABB worldBounds = triangle.getBounds().transformed(model);
+            cmd.call([&, worldBounds] {
+                occlusion.beginQueries(viewProj, eye);
+                occlusion.issueQuery(triangleOcclusion, worldBounds);
+                occlusion.endQueries();
+            });
 
-        angle += 0.01f;
+            cmd.call([&] { prepass.beginShadingPass(); });
+            const Shader& active = showOverdraw ? prepass.overdrawShader() : shader;
+            cmd.useProgram(active);
+            cmd.setMat4(active, "uModel", model.data());
 
-        float c = cos(angle);
-        float s = sin(angle);
+            cmd.call([&] {
+                if (const Texture* t = tex->get()) t->bind(0);
+            });
+            cmd.call([&] { occlusion.beginConditional(triangleOcclusion); });
+            cmd.draw(triangle);
+            cmd.call([&] {
+                occlusion.endConditional(triangleOcclusion);
+                prepass.endShadingPass();
+            });
+        }
 
-        float model[16] = {
-             c, s, 0, 0,
-            -s, c, 0, 0,
-             0, 0, 1, 0,
-             0, 0, 0, 1
-        };
+        cmd.call([&] {
+            gpuTimer.end();
+            gpuMicros += static_cast<int64_t>(gpuTimer.takeFinishedMs() * 1000.0);
+            Profiler::get().endFrame();
+            GLCapture::endFrame();
+            DebugOutput::drain(std::cerr);
+        });
 
-        shader.setMat4("uModel", model);
-     
-        tex.bind(0);
-        triangle.draw();
+        clock.endCpuWork();
+        scheduler.endFrame(); // before the swap, waiting for vsync is not work
+        // with a render thread this returns as soon as the commands are queued
+        renderer.submit(cmd);
+        // the swap happened inside submit() or, threaded, on the render thread since
+        for (FrameClock::Clock::time_point presented : renderer.takePresentTimes()) {
+            clock.markPresent(presented);
+        }
 
-        window.swapBuffers();
+        if (window.isHeadless() && framesLeft-- <= 1) {
+            renderer.stop();
+            for (FrameClock::Clock::time_point presented : renderer.takePresentTimes()) {
+                clock.markPresent(presented);
+            }
+            window.captureFrame("capture.ppm");
+            clock.print(std::cout);
+            renderer.printStats(std::cout);
+            Profiler::get().printSummary(std::cout);
+            Profiler::get().writeChromeTrace("profile.json");
+            break;
+        }
     }
+    renderer.stop();
+    GLCapture::finish();
     return 0;
 }
\ No newline at end of file
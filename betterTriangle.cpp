@@ -46,8 +46,36 @@ static bool GLCheckErrorStatus(const char* function, int line) {
     return false; 
 }
 
+// With KHR_debug the driver tells us about errors itself, so there's no need to
+// poll glGetError around every call (that stalls the driver)
+static bool gDebugOutput = false;
+
+static void APIENTRY GLDebugCallback(GLenum, GLenum type, GLuint id, GLenum severity,
+                                     GLsizei, const GLchar* message, const void*) {
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+        return;
+    std::cout << "OpenGL Debug: " << message
+              << "\tType: "     << type
+              << "\tId: "       << id << std::endl;
+}
+
+static void GLEnableDebugOutput() {
+    // glad leaves the pointer null when the driver doesn't have KHR_debug
+    if (!glDebugMessageCallback)
+        return;
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS); // so the message comes from inside the bad call
+    glDebugMessageCallback(GLDebugCallback, nullptr);
+    gDebugOutput = true;
+}
+
 // GLCheckErrorStatus("glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0)", 123(whatever line of code));
-#define GLCheck(x) GLClearAllErrors(); x; GLCheckErrorStatus(#x, __LINE__);
+// Release builds and drivers with debug output just make the call
+#ifdef NDEBUG
+#define GLCheck(x) x;
+#else
+#define GLCheck(x) if (gDebugOutput) { x; } else { GLClearAllErrors(); x; GLCheckErrorStatus(#x, __LINE__); }
+#endif
 
 SDL_Window* initializeSDL() {
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
@@ -58,6 +86,9 @@ SDL_Window* initializeSDL() {
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+#ifndef NDEBUG
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG);
+#endif
 
     gWindow = SDL_CreateWindow(
         "SDL2",
@@ -81,6 +112,9 @@ SDL_Window* initializeSDL() {
         std::cerr << "Failed to initialize GLAD\n" << "\n";
         exit(1);
     }
+#ifndef NDEBUG
+    GLEnableDebugOutput();
+#endif
     return gWindow;
 }
 
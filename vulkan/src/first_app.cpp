@@ -1,11 +1,64 @@
 #include "first_app.hpp"
+#include "lve_pipeline_registry.hpp"
+
+// std
+#include <iostream>
 
 namespace lve {
+
+    FirstApp::FirstApp() {
+        // Starts building the pipelines the last run used on worker threads. The lists are
+        // every layout and render pass the app creates pipelines with, in the order it first
+        // uses them, which is how the manifest numbers them.
+        lveDevice.pipelines().warmUp({pipelineConfig.pipelineLayout}, {pipelineConfig.renderPass});
+
+        lvePipeline = std::make_unique<LvePipeline>(
+            lveDevice,
+            "../src/Shaders/simple_shader.vert.spv",
+            "../src/Shaders/simple_shader.frag.spv",
+            pipelineConfig);
+        loadModels();
+    }
+
+    void FirstApp::loadModels() {
+        std::vector<LveModel::Vertex> vertices{
+            {{0.0f, -0.5f}},
+            {{0.5f, 0.5f}},
+            {{-0.5f, 0.5f}}};
+        lveModel = std::make_unique<LveModel>(lveDevice, vertices);
+        // every model's copies go out in one batch
+        lveDevice.uploads().flush();
+    }
     
     void FirstApp::run() {
+        lveDevice.pipelines().printStats(std::cout);
+        auto lastReport = LveFrameScheduler::Clock::now();
 
         while (!lveWindow.shouldClose()) {
-            glfwPollEvents();
+            // sleeps in the event queue instead of spinning on glfwPollEvents
+            lveWindow.waitEvents(scheduler.waitTimeout());
+
+            if (lveWindow.takeInvalidated()) {
+                scheduler.invalidate();
+            }
+            scheduler.setFocused(lveWindow.isFocused());
+            scheduler.setMinimized(lveWindow.isMinimized());
+
+            if (LveFrameScheduler::Clock::now() - lastReport > std::chrono::seconds(5)) {
+                lastReport = LveFrameScheduler::Clock::now();
+                double fps, busy;
+                uint64_t wakeups;
+                scheduler.takeUtilization(fps, busy, wakeups);
+                std::cout << fps << " fps, " << busy << "% busy, " << wakeups << " wakeups\n";
+            }
+
+            if (scheduler.beginFrame()) {
+                // nothing is recorded or presented yet, frames go here once there is a swapchain
+                scheduler.endFrame();
+            }
         }
+        lveDevice.uploads().waitAll();
+        lveDevice.uploads().printStats(std::cout);
+        lveDevice.allocator().printStats(std::cout);
     }
 }
\ No newline at end of file
@@ -2,6 +2,11 @@
 
 #include "lve_window.hpp"
 #include "lve_pipeline.hpp"
+#include "lve_model.hpp"
+#include "lve_frame_scheduler.hpp"
+
+// std
+#include <memory>
 
 namespace lve {
     class FirstApp {
@@ -10,14 +15,17 @@ namespace lve {
             static constexpr int WIDTH = 800;
             static constexpr int HEIGHT = 600;
 
+            FirstApp();
+
             void run();
         private:
+            void loadModels();
+
             LveWindow lveWindow{WIDTH, HEIGHT, "HELLOO VULKAN!"}; // window will be created with our first app class
             LveDevice lveDevice{lveWindow};
-            LvePipeline lvePipeline{
-                lveDevice, 
-                "../src/Shaders/simple_shader.vert.spv", 
-                "../src/Shaders/simple_shader.frag.spv", 
-                LvePipeline::defaultPipelineConfigInfo(WIDTH, HEIGHT)};
+            PipelineConfigInfo pipelineConfig = LvePipeline::defaultPipelineConfigInfo();
+            std::unique_ptr<LvePipeline> lvePipeline; // created after the pipeline warm-up has started
+            std::unique_ptr<LveModel> lveModel;
+            LveFrameScheduler scheduler;
     };
 }
\ No newline at end of file
@@ -0,0 +1,556 @@
+#include "lve_allocator.hpp"
+
+// std headers
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace lve {
+
+namespace {
+
+// TLSF size classes: the first level is the power of two, the second splits that range
+// into kSlCount linear steps. Everything below kSmallSize shares first level 0.
+constexpr uint32_t kSlLog2 = 4;
+constexpr uint32_t kSlCount = 1u << kSlLog2;
+constexpr uint32_t kSmallLog2 = 8;
+constexpr VkDeviceSize kSmallSize = VkDeviceSize{1} << kSmallLog2;
+constexpr uint32_t kFlCount = 64 - kSmallLog2 + 1;
+
+// a free remainder smaller than this stays attached to the allocation as waste
+constexpr VkDeviceSize kMinFreeSize = 256;
+
+constexpr VkDeviceSize kDefaultBlockSize = VkDeviceSize{64} << 20;
+
+uint32_t floorLog2(VkDeviceSize v) { return 63 - static_cast<uint32_t>(__builtin_clzll(v)); }
+uint32_t lowestBit(uint64_t v) { return static_cast<uint32_t>(__builtin_ctzll(v)); }
+
+VkDeviceSize alignUp(VkDeviceSize v, VkDeviceSize alignment) {
+  return (v + alignment - 1) / alignment * alignment;
+}
+
+// Up to the smallest size of the next class, so every node in or above that class fits
+VkDeviceSize roundUpToClass(VkDeviceSize size) {
+  if (size < kSmallSize) {
+    return alignUp(size, kSmallSize / kSlCount);
+  }
+  return size + (VkDeviceSize{1} << (floorLog2(size) - kSlLog2)) - 1;
+}
+
+void mapping(VkDeviceSize size, uint32_t &fl, uint32_t &sl) {
+  if (size < kSmallSize) {
+    fl = 0;
+    sl = static_cast<uint32_t>(size / (kSmallSize / kSlCount));
+  } else {
+    uint32_t log2 = floorLog2(size);
+    sl = static_cast<uint32_t>(size >> (log2 - kSlLog2)) ^ kSlCount;
+    fl = log2 - kSmallLog2 + 1;
+  }
+}
+
+}  // namespace
+
+struct Node {
+  VkDeviceSize offset = 0;
+  VkDeviceSize size = 0;  // footprint, at least allocation->size
+  bool free = true;
+  Node *prevPhys = nullptr;
+  Node *nextPhys = nullptr;
+  Node *prevFree = nullptr;
+  Node *nextFree = nullptr;
+  LveAllocation *allocation = nullptr;
+};
+
+struct Block {
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  VkDeviceSize size = 0;
+  uint32_t memoryType = 0;
+  LveResourceKind kind = LveResourceKind::Linear;
+  char *mapped = nullptr;
+
+  Node *first = nullptr;
+  uint32_t allocationCount = 0;
+  VkDeviceSize usedBytes = 0;
+
+  uint64_t flBitmap = 0;
+  uint32_t slBitmap[kFlCount] = {};
+  Node *freeLists[kFlCount][kSlCount] = {};
+
+  void insertFree(Node *node) {
+    uint32_t fl, sl;
+    mapping(node->size, fl, sl);
+    node->free = true;
+    node->prevFree = nullptr;
+    node->nextFree = freeLists[fl][sl];
+    if (node->nextFree) node->nextFree->prevFree = node;
+    freeLists[fl][sl] = node;
+    flBitmap |= uint64_t{1} << fl;
+    slBitmap[fl] |= 1u << sl;
+  }
+
+  void removeFree(Node *node) {
+    uint32_t fl, sl;
+    mapping(node->size, fl, sl);
+    if (node->prevFree) node->prevFree->nextFree = node->nextFree;
+    if (node->nextFree) node->nextFree->prevFree = node->prevFree;
+    if (freeLists[fl][sl] == node) {
+      freeLists[fl][sl] = node->nextFree;
+      if (!freeLists[fl][sl]) {
+        slBitmap[fl] &= ~(1u << sl);
+        if (!slBitmap[fl]) flBitmap &= ~(uint64_t{1} << fl);
+      }
+    }
+    node->prevFree = node->nextFree = nullptr;
+    node->free = false;
+  }
+
+  // Any free node of at least size, or nullptr. The size is rounded up to the next class
+  // first, so whatever heads the list found is big enough without walking it.
+  Node *findFree(VkDeviceSize size) const {
+    size = roundUpToClass(size);
+    uint32_t fl, sl;
+    mapping(size, fl, sl);
+    if (fl >= kFlCount) return nullptr;
+
+    uint32_t slMap = sl < kSlCount ? slBitmap[fl] & (~0u << sl) : 0;
+    if (!slMap) {
+      uint64_t flMap = fl + 1 < kFlCount ? flBitmap & (~uint64_t{0} << (fl + 1)) : 0;
+      if (!flMap) return nullptr;
+      fl = lowestBit(flMap);
+      slMap = slBitmap[fl];
+    }
+    return freeLists[fl][lowestBit(slMap)];
+  }
+};
+
+LveAllocator::LveAllocator(
+    VkPhysicalDevice physicalDevice,
+    VkDevice device,
+    VkDeviceSize blockSize,
+    VkDeviceSize dedicatedThreshold)
+    : device{device},
+      blockSize{blockSize ? blockSize : kDefaultBlockSize},
+      dedicatedThreshold{dedicatedThreshold} {
+  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+  bufferImageGranularity = properties.limits.bufferImageGranularity;
+  maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+}
+
+LveAllocator::~LveAllocator() {
+  for (auto &block : blocks) {
+    if (block->allocationCount > 0) {
+      std::cerr << "LveAllocator: " << block->allocationCount << " allocations leaked\n";
+    }
+    destroyBlock(block.get());
+  }
+  for (auto &allocation : dedicatedAllocations) {
+    vkFreeMemory(device, allocation->memory, nullptr);
+  }
+}
+
+uint32_t LveAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+  for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+    if ((typeFilter & (1 << i)) &&
+        (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+      return i;
+    }
+  }
+  throw std::runtime_error("failed to find suitable memory type!");
+}
+
+VkDeviceSize LveAllocator::preferredBlockSize(uint32_t memoryType) const {
+  // small heaps (BAR memory is often 256 MiB) would be gone in a handful of blocks
+  VkDeviceSize heapSize = memProperties.memoryHeaps[memProperties.memoryTypes[memoryType].heapIndex].size;
+  return std::min(blockSize, alignUp(heapSize / 8, 1 << 20));
+}
+
+VkDeviceSize LveAllocator::dedicatedThresholdFor(uint32_t memoryType) const {
+  // half of this type's blocks, small heaps have small blocks
+  return dedicatedThreshold ? dedicatedThreshold : preferredBlockSize(memoryType) / 2;
+}
+
+LveResourceKind LveAllocator::blockKind(LveResourceKind kind) const {
+  // with a granularity of 1 buffers and images can sit right next to each other
+  return bufferImageGranularity > 1 ? kind : LveResourceKind::Linear;
+}
+
+Block *LveAllocator::createBlock(uint32_t memoryType, LveResourceKind kind, VkDeviceSize minSize) {
+  if (vulkanAllocations + 1 >= maxAllocationCount) {
+    throw std::runtime_error("maxMemoryAllocationCount reached!");
+  }
+
+  // out of memory at the preferred size, try smaller blocks before giving up
+  VkDeviceSize size = std::max(preferredBlockSize(memoryType), minSize);
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  for (;;) {
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) == VK_SUCCESS) break;
+    if (size / 2 < minSize) {
+      throw std::runtime_error("failed to allocate memory block!");
+    }
+    size /= 2;
+  }
+  vulkanAllocations++;
+
+  auto block = std::make_unique<Block>();
+  block->memory = memory;
+  block->size = size;
+  block->memoryType = memoryType;
+  block->kind = kind;
+  if (memProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+    void *data = nullptr;
+    vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data);
+    block->mapped = static_cast<char *>(data);
+  }
+
+  Node *node = new Node();
+  node->size = size;
+  block->first = node;
+  block->insertFree(node);
+
+  blocks.push_back(std::move(block));
+  return blocks.back().get();
+}
+
+void LveAllocator::destroyBlock(Block *block) {
+  Node *node = block->first;
+  while (node) {
+    Node *next = node->nextPhys;
+    delete node->allocation;
+    delete node;
+    node = next;
+  }
+  if (block->mapped) {
+    vkUnmapMemory(device, block->memory);
+  }
+  vkFreeMemory(device, block->memory, nullptr);
+  vulkanAllocations--;
+}
+
+Node *LveAllocator::allocateFromBlock(Block &block, VkDeviceSize size, VkDeviceSize alignment) {
+  // asking for the worst case padding up front means the first fit always fits
+  Node *node = block.findFree(size + alignment - 1);
+  if (!node) return nullptr;
+  block.removeFree(node);
+
+  // the padding goes to the previous node, which is in use (free neighbours are always merged)
+  VkDeviceSize padding = alignUp(node->offset, alignment) - node->offset;
+  if (padding > 0) {
+    node->prevPhys->size += padding;
+    node->offset += padding;
+    node->size -= padding;
+  }
+
+  if (node->size - size >= kMinFreeSize) {
+    Node *rest = new Node();
+    rest->offset = node->offset + size;
+    rest->size = node->size - size;
+    rest->prevPhys = node;
+    rest->nextPhys = node->nextPhys;
+    if (rest->nextPhys) rest->nextPhys->prevPhys = rest;
+    node->nextPhys = rest;
+    node->size = size;
+    block.insertFree(rest);
+  }
+  return node;
+}
+
+void LveAllocator::freeNode(Block &block, Node *node) {
+  node->allocation = nullptr;
+
+  Node *prev = node->prevPhys;
+  if (prev && prev->free) {
+    block.removeFree(prev);
+    prev->size += node->size;
+    prev->nextPhys = node->nextPhys;
+    if (prev->nextPhys) prev->nextPhys->prevPhys = prev;
+    delete node;
+    node = prev;
+  }
+  Node *next = node->nextPhys;
+  if (next && next->free) {
+    block.removeFree(next);
+    node->size += next->size;
+    node->nextPhys = next->nextPhys;
+    if (node->nextPhys) node->nextPhys->prevPhys = node;
+    delete next;
+  }
+  block.insertFree(node);
+}
+
+LveAllocation *LveAllocator::allocateDedicated(VkDeviceSize size, uint32_t memoryType) {
+  if (vulkanAllocations + 1 >= maxAllocationCount) {
+    throw std::runtime_error("maxMemoryAllocationCount reached!");
+  }
+
+  VkMemoryAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  allocInfo.allocationSize = size;
+  allocInfo.memoryTypeIndex = memoryType;
+
+  auto allocation = std::make_unique<LveAllocation>();
+  if (vkAllocateMemory(device, &allocInfo, nullptr, &allocation->memory) != VK_SUCCESS) {
+    throw std::runtime_error("failed to allocate dedicated memory!");
+  }
+  vulkanAllocations++;
+
+  allocation->size = size;
+  allocation->memoryType = memoryType;
+  allocation->dedicated = true;
+  if (memProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+    vkMapMemory(device, allocation->memory, 0, VK_WHOLE_SIZE, 0, &allocation->mapped);
+  }
+
+  dedicatedAllocations.push_back(std::move(allocation));
+  return dedicatedAllocations.back().get();
+}
+
+LveAllocation *LveAllocator::allocate(
+    const VkMemoryRequirements &requirements,
+    VkMemoryPropertyFlags properties,
+    LveResourceKind kind) {
+  uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (requirements.size >= dedicatedThresholdFor(memoryType)) {
+    return allocateDedicated(requirements.size, memoryType);
+  }
+
+  kind = blockKind(kind);
+  VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+  Block *block = nullptr;
+  Node *node = nullptr;
+  for (auto &candidate : blocks) {
+    if (candidate->memoryType != memoryType || candidate->kind != kind) continue;
+    node = allocateFromBlock(*candidate, requirements.size, alignment);
+    if (node) {
+      block = candidate.get();
+      break;
+    }
+  }
+  if (!node) {
+    // findFree rounds the padded size up to its class, a block of just the size would miss
+    block = createBlock(memoryType, kind, roundUpToClass(requirements.size + alignment - 1));
+    node = allocateFromBlock(*block, requirements.size, alignment);
+    if (!node) {
+      throw std::runtime_error("failed to allocate from a new memory block!");
+    }
+  }
+
+  auto *allocation = new LveAllocation();
+  allocation->memory = block->memory;
+  allocation->offset = node->offset;
+  allocation->size = requirements.size;
+  allocation->mapped = block->mapped ? block->mapped + node->offset : nullptr;
+  allocation->memoryType = memoryType;
+  allocation->block = block;
+  allocation->node = node;
+  allocation->alignment = alignment;
+  node->allocation = allocation;
+  block->allocationCount++;
+  block->usedBytes += requirements.size;
+  return allocation;
+}
+
+void LveAllocator::free(LveAllocation *allocation) {
+  if (!allocation) return;
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (allocation->dedicated) {
+    if (allocation->mapped) {
+      vkUnmapMemory(device, allocation->memory);
+    }
+    vkFreeMemory(device, allocation->memory, nullptr);
+    vulkanAllocations--;
+    auto it = std::find_if(
+        dedicatedAllocations.begin(),
+        dedicatedAllocations.end(),
+        [allocation](const auto &a) { return a.get() == allocation; });
+    dedicatedAllocations.erase(it);
+    return;
+  }
+
+  Block *block = allocation->block;
+  block->allocationCount--;
+  block->usedBytes -= allocation->size;
+  freeNode(*block, allocation->node);
+  delete allocation;
+
+  // keep one empty block per memory type around, so a free / allocate pattern at the
+  // edge of a block doesn't allocate and release device memory every frame
+  if (block->allocationCount == 0) {
+    bool otherEmpty = std::any_of(blocks.begin(), blocks.end(), [block](const auto &b) {
+      return b.get() != block && b->memoryType == block->memoryType && b->kind == block->kind &&
+             b->allocationCount == 0;
+    });
+    if (otherEmpty) {
+      destroyBlock(block);
+      blocks.erase(std::find_if(blocks.begin(), blocks.end(), [block](const auto &b) {
+        return b.get() == block;
+      }));
+    }
+  }
+}
+
+LveDefragStats LveAllocator::defragment(const MoveFn &move, VkDeviceSize maxBytesToMove) {
+  std::lock_guard<std::mutex> defragLock(defragMutex);
+  LveDefragStats result;
+
+  struct PlannedMove {
+    LveAllocation *allocation;
+    Block *target;
+    Node *destination;
+    void *mapped;
+    bool moved;
+  };
+  std::vector<PlannedMove> moves;
+  std::vector<Block *> sources;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // least used first: those are the cheapest to empty
+    std::vector<Block *> order;
+    for (auto &block : blocks) order.push_back(block.get());
+    std::sort(order.begin(), order.end(), [](const Block *a, const Block *b) {
+      return a->usedBytes < b->usedBytes;
+    });
+
+    VkDeviceSize plannedBytes = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+      Block *source = order[i];
+      if (source->allocationCount == 0) continue;
+
+      // a node whose allocation lives elsewhere is a destination reserved by this pass
+      std::vector<LveAllocation *> candidates;
+      for (Node *node = source->first; node; node = node->nextPhys) {
+        if (!node->free && node->allocation->node == node && node->allocation->movable) {
+          candidates.push_back(node->allocation);
+        }
+      }
+
+      size_t plannedBefore = moves.size();
+      for (LveAllocation *allocation : candidates) {
+        if (plannedBytes + allocation->size > maxBytesToMove) break;
+
+        // only into blocks that are fuller than this one, otherwise blocks just trade contents
+        for (size_t j = order.size(); j-- > i + 1;) {
+          Block *target = order[j];
+          if (target->memoryType != source->memoryType || target->kind != source->kind) continue;
+
+          Node *destination = allocateFromBlock(*target, allocation->size, allocation->alignment);
+          if (!destination) continue;
+
+          // counted against the target while the move runs, so nothing else takes it
+          // and free() can't release the block under it
+          destination->allocation = allocation;
+          target->allocationCount++;
+          target->usedBytes += allocation->size;
+
+          void *mapped = target->mapped ? target->mapped + destination->offset : nullptr;
+          moves.push_back({allocation, target, destination, mapped, false});
+          plannedBytes += allocation->size;
+          break;
+        }
+      }
+      if (moves.size() > plannedBefore) {
+        sources.push_back(source);
+      }
+    }
+  }
+
+  // without the lock: the callback creates resources and staging buffers through this
+  // allocator, and copies take a while
+  for (PlannedMove &m : moves) {
+    m.moved = move(*m.allocation, m.target->memory, m.destination->offset, m.mapped);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  for (PlannedMove &m : moves) {
+    LveAllocation *allocation = m.allocation;
+    if (!m.moved) {
+      m.target->allocationCount--;
+      m.target->usedBytes -= allocation->size;
+      freeNode(*m.target, m.destination);
+      continue;
+    }
+
+    Block *source = allocation->block;
+    source->allocationCount--;
+    source->usedBytes -= allocation->size;
+    freeNode(*source, allocation->node);
+
+    allocation->memory = m.target->memory;
+    allocation->offset = m.destination->offset;
+    allocation->mapped = m.mapped;
+    allocation->block = m.target;
+    allocation->node = m.destination;
+
+    result.moves++;
+    result.bytesMoved += allocation->size;
+  }
+
+  for (Block *block : sources) {
+    if (block->allocationCount != 0) continue;
+    destroyBlock(block);
+    blocks.erase(std::find_if(blocks.begin(), blocks.end(), [block](const auto &b) {
+      return b.get() == block;
+    }));
+    result.blocksFreed++;
+  }
+  return result;
+}
+
+std::vector<LveHeapStats> LveAllocator::stats() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  std::vector<LveHeapStats> heaps(memProperties.memoryHeapCount);
+  for (uint32_t i = 0; i < memProperties.memoryHeapCount; i++) {
+    heaps[i].heapIndex = i;
+    heaps[i].heapSize = memProperties.memoryHeaps[i].size;
+  }
+
+  for (auto &block : blocks) {
+    LveHeapStats &heap = heaps[memProperties.memoryTypes[block->memoryType].heapIndex];
+    heap.blocks++;
+    heap.blockBytes += block->size;
+    heap.allocations += block->allocationCount;
+    heap.usedBytes += block->usedBytes;
+    for (Node *node = block->first; node; node = node->nextPhys) {
+      if (node->free) {
+        heap.largestFree = std::max(heap.largestFree, node->size);
+      } else {
+        heap.wastedBytes += node->size - node->allocation->size;
+      }
+    }
+  }
+  for (auto &allocation : dedicatedAllocations) {
+    LveHeapStats &heap = heaps[memProperties.memoryTypes[allocation->memoryType].heapIndex];
+    heap.dedicatedAllocations++;
+    heap.allocations++;
+    heap.blockBytes += allocation->size;
+    heap.usedBytes += allocation->size;
+  }
+  return heaps;
+}
+
+void LveAllocator::printStats(std::ostream &out) {
+  constexpr double MiB = 1024.0 * 1024.0;
+  for (const LveHeapStats &heap : stats()) {
+    if (heap.blockBytes == 0) continue;
+    out << "heap " << heap.heapIndex << " (" << heap.heapSize / MiB << " MiB): " << heap.blocks
+        << " blocks + " << heap.dedicatedAllocations << " dedicated, " << heap.allocations
+        << " allocations, " << heap.usedBytes / MiB << " / " << heap.blockBytes / MiB
+        << " MiB used, " << heap.wastedBytes / 1024.0 << " KiB wasted, largest free "
+        << heap.largestFree / MiB << " MiB\n";
+  }
+  out << vulkanAllocations << " of " << maxAllocationCount << " vkAllocateMemory allocations\n";
+}
+
+}  // namespace lve
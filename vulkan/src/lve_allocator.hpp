@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// std lib headers
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace lve {
+
+struct Block;
+struct Node;
+
+// Buffers and linear images vs optimal tiling images. Only matters when the device has a
+// bufferImageGranularity above 1, the two kinds then never share a block.
+enum class LveResourceKind { Linear, Optimal };
+
+// A range of device memory handed out by LveAllocator. Owned by the allocator, so the
+// defragmentation pass can move it; bind resources with memory + offset.
+struct LveAllocation {
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  VkDeviceSize offset = 0;
+  VkDeviceSize size = 0;
+  void *mapped = nullptr;  // host visible memory stays mapped for the allocation's lifetime
+  uint32_t memoryType = 0;
+  bool dedicated = false;
+
+  // Only allocations marked movable are touched by defragment(), userData is for finding
+  // the resource that lives in them from the move callback
+  bool movable = false;
+  void *userData = nullptr;
+
+ private:
+  friend class LveAllocator;
+  Block *block = nullptr;
+  Node *node = nullptr;
+  VkDeviceSize alignment = 1;
+};
+
+struct LveHeapStats {
+  uint32_t heapIndex = 0;
+  VkDeviceSize heapSize = 0;
+  uint32_t blocks = 0;
+  uint32_t dedicatedAllocations = 0;
+  uint32_t allocations = 0;
+  VkDeviceSize blockBytes = 0;   // everything allocated from Vulkan, dedicated included
+  VkDeviceSize usedBytes = 0;    // what was asked for
+  VkDeviceSize wastedBytes = 0;  // alignment padding and split remainders too small to reuse
+  VkDeviceSize largestFree = 0;
+};
+
+struct LveDefragStats {
+  uint32_t moves = 0;
+  VkDeviceSize bytesMoved = 0;
+  uint32_t blocksFreed = 0;
+};
+
+// Suballocates buffers and images out of large per-memory-type blocks instead of one
+// vkAllocateMemory per resource (slow, and maxMemoryAllocationCount can be as low as 4096).
+//
+// Each block is managed by a TLSF (two level segregated fit) allocator: free ranges sit in
+// size class lists indexed by two bitmaps, so finding a fit and freeing with neighbour
+// merging are O(1) whatever the number of allocations.
+// Resources of at least dedicatedThreshold (half a block of their memory type by default)
+// get their own vkAllocateMemory.
+//
+// Thread safe, one lock around everything.
+class LveAllocator {
+ public:
+  // 0 picks the defaults: 64 MiB blocks (an eighth of the heap on small heaps),
+  // dedicated allocations from half of the memory type's block size up
+  LveAllocator(
+      VkPhysicalDevice physicalDevice,
+      VkDevice device,
+      VkDeviceSize blockSize = 0,
+      VkDeviceSize dedicatedThreshold = 0);
+  ~LveAllocator();
+
+  LveAllocator(const LveAllocator &) = delete;
+  LveAllocator &operator=(const LveAllocator &) = delete;
+
+  // Throws when no memory type matches or the device is out of memory
+  LveAllocation *allocate(
+      const VkMemoryRequirements &requirements,
+      VkMemoryPropertyFlags properties,
+      LveResourceKind kind);
+  void free(LveAllocation *allocation);
+
+  uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+  const VkPhysicalDeviceMemoryProperties &memoryProperties() const { return memProperties; }
+
+  // Called for every planned move with the allocation still at its old place. Return true
+  // once the resource lives at newMemory / newOffset (created, bound, contents copied and
+  // the copy finished), false to leave it where it is. Runs without the allocator's lock, so
+  // it may allocate and free through the allocator, except for the allocation being moved.
+  using MoveFn = std::function<bool(
+      LveAllocation &allocation, VkDeviceMemory newMemory, VkDeviceSize newOffset, void *newMapped)>;
+
+  // Empties the least used blocks of each memory type into the others and releases the
+  // ones that end up empty. Meant for loading screens, not for every frame. Passes are
+  // serialized, the destinations stay reserved until the callbacks are done.
+  LveDefragStats defragment(const MoveFn &move, VkDeviceSize maxBytesToMove = VK_WHOLE_SIZE);
+
+  std::vector<LveHeapStats> stats();
+  void printStats(std::ostream &out);
+
+ private:
+  Block *createBlock(uint32_t memoryType, LveResourceKind kind, VkDeviceSize minSize);
+  void destroyBlock(Block *block);
+  Node *allocateFromBlock(Block &block, VkDeviceSize size, VkDeviceSize alignment);
+  void freeNode(Block &block, Node *node);
+  LveAllocation *allocateDedicated(VkDeviceSize size, uint32_t memoryType);
+  VkDeviceSize preferredBlockSize(uint32_t memoryType) const;
+  VkDeviceSize dedicatedThresholdFor(uint32_t memoryType) const;
+  LveResourceKind blockKind(LveResourceKind kind) const;
+
+  VkDevice device;
+  VkPhysicalDeviceMemoryProperties memProperties;
+  VkDeviceSize bufferImageGranularity;
+  uint32_t maxAllocationCount;
+  VkDeviceSize blockSize;
+  VkDeviceSize dedicatedThreshold;  // 0 = half of preferredBlockSize
+
+  std::mutex mutex;
+  std::mutex defragMutex;  // taken before mutex, never while holding it
+  std::vector<std::unique_ptr<Block>> blocks;
+  std::vector<std::unique_ptr<LveAllocation>> dedicatedAllocations;
+  uint32_t vulkanAllocations = 0;
+};
+
+}  // namespace lve
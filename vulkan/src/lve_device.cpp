@@ -1,7 +1,10 @@
 #include "lve_device.hpp"
+#include "lve_pipeline_registry.hpp"
 
 // std headers
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <set>
 #include <unordered_set>
@@ -54,11 +57,21 @@ LveDevice::LveDevice(LveWindow &window) : window{window} {
   createSurface();  // connection between the window and vulkan's ability to display results
   pickPhysicalDevice(); // Graphics device
   createLogicalDevice(); // Describes what features of our physical device we want to use
+  allocator_ = std::make_unique<LveAllocator>(physicalDevice, device_); // buffers and images share big memory blocks
+  createPipelineCache(); // compiled pipelines from the last run
+  pipelines_ = std::make_unique<LvePipelineRegistry>(*this); // shared shader modules and pipelines
   createCommandPool(); // for command buffer allocation
+  uploads_ = std::make_unique<LveUploadContext>(*this); // staging ring, copies go out in batches
 }
 
 LveDevice::~LveDevice() {
+  uploads_.reset();
+  pipelines_.reset();
+  savePipelineCache();
+  vkDestroyPipelineCache(device_, pipelineCache_, nullptr);
+  vkDestroyCommandPool(device_, transferCommandPool, nullptr);
   vkDestroyCommandPool(device_, commandPool, nullptr);
+  allocator_.reset();
   vkDestroyDevice(device_, nullptr);
 
   if (enableValidationLayers) {
@@ -139,6 +152,9 @@ void LveDevice::createLogicalDevice() {
 
   std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
   std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily};
+  if (indices.transferFamilyHasValue) {
+    uniqueQueueFamilies.insert(indices.transferFamily);
+  }
 
   float queuePriority = 1.0f;
   for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -178,6 +194,84 @@ void LveDevice::createLogicalDevice() {
 
   vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
   vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+
+  // uploads go to the transfer queue when there is one (most discrete GPUs), otherwise they
+  // share the graphics queue (integrated GPUs, lavapipe)
+  transferFamily_ = indices.transferFamilyHasValue ? indices.transferFamily : indices.graphicsFamily;
+  vkGetDeviceQueue(device_, transferFamily_, 0, &transferQueue_);
+}
+
+void LveDevice::createPipelineCache() {
+  std::vector<char> data;
+  std::ifstream file{pipelineCachePath, std::ios::ate | std::ios::binary};
+  if (file.is_open()) {
+    data.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(data.data(), data.size());
+    if (!file || !isPipelineCacheCompatible(data)) {
+      std::cout << "pipeline cache: " << pipelineCachePath << " is stale, starting cold" << std::endl;
+      data.clear();
+    }
+  }
+
+  VkPipelineCacheCreateInfo cacheInfo = {};
+  cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  cacheInfo.initialDataSize = data.size();
+  cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+  if (vkCreatePipelineCache(device_, &cacheInfo, nullptr, &pipelineCache_) != VK_SUCCESS) {
+    // drivers may still reject data that passed the header check, retry empty
+    cacheInfo.initialDataSize = 0;
+    cacheInfo.pInitialData = nullptr;
+    data.clear();
+    if (vkCreatePipelineCache(device_, &cacheInfo, nullptr, &pipelineCache_) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create pipeline cache!");
+    }
+  }
+  pipelineCacheWarm_ = !data.empty();
+}
+
+// VkPipelineCacheHeaderVersionOne: the data only works with the driver and GPU that made it
+bool LveDevice::isPipelineCacheCompatible(const std::vector<char> &data) {
+  const size_t headerSize = 16 + VK_UUID_SIZE;
+  if (data.size() < headerSize) {
+    return false;
+  }
+
+  uint32_t header[4];
+  std::memcpy(header, data.data(), sizeof(header));
+  return header[0] >= headerSize && header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header[2] == properties.vendorID && header[3] == properties.deviceID &&
+         std::memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void LveDevice::savePipelineCache() {
+  size_t size = 0;
+  if (vkGetPipelineCacheData(device_, pipelineCache_, &size, nullptr) != VK_SUCCESS || size == 0) {
+    return;
+  }
+  std::vector<char> data(size);
+  if (vkGetPipelineCacheData(device_, pipelineCache_, &size, data.data()) != VK_SUCCESS) {
+    return;
+  }
+
+  // written next to the old file and renamed over it, a crash mid write can't leave half a cache
+  std::string tmpPath = pipelineCachePath + ".tmp";
+  {
+    std::ofstream file{tmpPath, std::ios::binary | std::ios::trunc};
+    file.write(data.data(), size);
+    if (!file.flush()) {
+      std::cerr << "pipeline cache: failed to write " << tmpPath << std::endl;
+      return;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(tmpPath, pipelineCachePath, error);
+  if (error) {
+    std::cerr << "pipeline cache: failed to replace " << pipelineCachePath << ": " << error.message()
+              << std::endl;
+    std::filesystem::remove(tmpPath, error);
+  }
 }
 
 void LveDevice::createCommandPool() {
@@ -192,6 +286,11 @@ void LveDevice::createCommandPool() {
   if (vkCreateCommandPool(device_, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
     throw std::runtime_error("failed to create command pool!");
   }
+
+  poolInfo.queueFamilyIndex = transferFamily_;
+  if (vkCreateCommandPool(device_, &poolInfo, nullptr, &transferCommandPool) != VK_SUCCESS) {
+    throw std::runtime_error("failed to create transfer command pool!");
+  }
 }
 
 void LveDevice::createSurface() { window.createWindowSurface(instance, &surface_); }
@@ -346,6 +445,22 @@ QueueFamilyIndices LveDevice::findQueueFamilies(VkPhysicalDevice device) {
     i++;
   }
 
+  // the copy engine: transfer without graphics, and preferably without compute either
+  // (async compute families work, but those are better left for compute)
+  bool transferOnly = false;
+  for (uint32_t family = 0; family < queueFamilyCount; family++) {
+    VkQueueFlags flags = queueFamilies[family].queueFlags;
+    if (queueFamilies[family].queueCount == 0 || !(flags & VK_QUEUE_TRANSFER_BIT) ||
+        (flags & VK_QUEUE_GRAPHICS_BIT)) {
+      continue;
+    }
+    if (!indices.transferFamilyHasValue || (!transferOnly && !(flags & VK_QUEUE_COMPUTE_BIT))) {
+      indices.transferFamily = family;
+      indices.transferFamilyHasValue = true;
+      transferOnly = !(flags & VK_QUEUE_COMPUTE_BIT);
+    }
+  }
+
   return indices;
 }
 
@@ -392,16 +507,7 @@ VkFormat LveDevice::findSupportedFormat(
 }
 
 uint32_t LveDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-  VkPhysicalDeviceMemoryProperties memProperties;
-  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-  for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-    if ((typeFilter & (1 << i)) &&
-        (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-      return i;
-    }
-  }
-
-  throw std::runtime_error("failed to find suitable memory type!");
+  return allocator_->findMemoryType(typeFilter, properties);
 }
 
 void LveDevice::createBuffer(
@@ -409,7 +515,7 @@ void LveDevice::createBuffer(
     VkBufferUsageFlags usage,
     VkMemoryPropertyFlags properties,
     VkBuffer &buffer,
-    VkDeviceMemory &bufferMemory) {
+    LveAllocation *&bufferAllocation) {
   VkBufferCreateInfo bufferInfo{};
   bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
   bufferInfo.size = size;
@@ -423,16 +529,14 @@ void LveDevice::createBuffer(
   VkMemoryRequirements memRequirements;
   vkGetBufferMemoryRequirements(device_, buffer, &memRequirements);
 
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-  if (vkAllocateMemory(device_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-    throw std::runtime_error("failed to allocate vertex buffer memory!");
-  }
+  bufferAllocation = allocator_->allocate(memRequirements, properties, LveResourceKind::Linear);
+  vkBindBufferMemory(device_, buffer, bufferAllocation->memory, bufferAllocation->offset);
+}
 
-  vkBindBufferMemory(device_, buffer, bufferMemory, 0);
+void LveDevice::destroyBuffer(VkBuffer buffer, LveAllocation *bufferAllocation) {
+  if (uploads_) uploads_->forgetBuffer(buffer);
+  vkDestroyBuffer(device_, buffer, nullptr);
+  allocator_->free(bufferAllocation);
 }
 
 VkCommandBuffer LveDevice::beginSingleTimeCommands() {
@@ -467,50 +571,20 @@ void LveDevice::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
   vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
 }
 
-void LveDevice::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
-  VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-  VkBufferCopy copyRegion{};
-  copyRegion.srcOffset = 0;  // Optional
-  copyRegion.dstOffset = 0;  // Optional
-  copyRegion.size = size;
-  vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-  endSingleTimeCommands(commandBuffer);
+LveUploadTicket LveDevice::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+  return uploads_->copyBuffer(srcBuffer, dstBuffer, size);
 }
 
-void LveDevice::copyBufferToImage(
+LveUploadTicket LveDevice::copyBufferToImage(
     VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount) {
-  VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-  VkBufferImageCopy region{};
-  region.bufferOffset = 0;
-  region.bufferRowLength = 0;
-  region.bufferImageHeight = 0;
-
-  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  region.imageSubresource.mipLevel = 0;
-  region.imageSubresource.baseArrayLayer = 0;
-  region.imageSubresource.layerCount = layerCount;
-
-  region.imageOffset = {0, 0, 0};
-  region.imageExtent = {width, height, 1};
-
-  vkCmdCopyBufferToImage(
-      commandBuffer,
-      buffer,
-      image,
-      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-      1,
-      &region);
-  endSingleTimeCommands(commandBuffer);
+  return uploads_->copyBufferToImage(buffer, image, width, height, layerCount);
 }
 
 void LveDevice::createImageWithInfo(
     const VkImageCreateInfo &imageInfo,
     VkMemoryPropertyFlags properties,
     VkImage &image,
-    VkDeviceMemory &imageMemory) {
+    LveAllocation *&imageAllocation) {
   if (vkCreateImage(device_, &imageInfo, nullptr, &image) != VK_SUCCESS) {
     throw std::runtime_error("failed to create image!");
   }
@@ -518,18 +592,20 @@ void LveDevice::createImageWithInfo(
   VkMemoryRequirements memRequirements;
   vkGetImageMemoryRequirements(device_, image, &memRequirements);
 
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+  LveResourceKind kind = imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL ? LveResourceKind::Optimal
+                                                                      : LveResourceKind::Linear;
+  imageAllocation = allocator_->allocate(memRequirements, properties, kind);
 
-  if (vkAllocateMemory(device_, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-    throw std::runtime_error("failed to allocate image memory!");
-  }
-
-  if (vkBindImageMemory(device_, image, imageMemory, 0) != VK_SUCCESS) {
+  if (vkBindImageMemory(device_, image, imageAllocation->memory, imageAllocation->offset) !=
+      VK_SUCCESS) {
     throw std::runtime_error("failed to bind image memory!");
   }
 }
 
+void LveDevice::destroyImage(VkImage image, LveAllocation *imageAllocation) {
+  if (uploads_) uploads_->forgetImage(image);
+  vkDestroyImage(device_, image, nullptr);
+  allocator_->free(imageAllocation);
+}
+
 }  // namespace lve
\ No newline at end of file
@@ -1,13 +1,18 @@
 #pragma once
 
+#include "lve_allocator.hpp"
+#include "lve_upload_context.hpp"
 #include "lve_window.hpp"
 
 // std lib headers
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace lve {
 
+class LvePipelineRegistry;
+
 struct SwapChainSupportDetails {
   VkSurfaceCapabilitiesKHR capabilities; 
   std::vector<VkSurfaceFormatKHR> formats;
@@ -17,8 +22,10 @@ struct SwapChainSupportDetails {
 struct QueueFamilyIndices {
   uint32_t graphicsFamily;
   uint32_t presentFamily;
+  uint32_t transferFamily;  // a family without graphics, optional
   bool graphicsFamilyHasValue = false;
   bool presentFamilyHasValue = false;
+  bool transferFamilyHasValue = false;
   bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
 };
 
@@ -44,6 +51,19 @@ class LveDevice {
   VkSurfaceKHR surface() { return surface_; }
   VkQueue graphicsQueue() { return graphicsQueue_; }
   VkQueue presentQueue() { return presentQueue_; }
+  // The dedicated transfer queue and a pool for its family when the device has one,
+  // otherwise the graphics queue and a second pool for the graphics family
+  VkQueue transferQueue() { return transferQueue_; }
+  VkCommandPool getTransferCommandPool() { return transferCommandPool; }
+  uint32_t transferQueueFamily() { return transferFamily_; }
+  bool hasDedicatedTransferQueue() { return transferQueue_ != graphicsQueue_; }
+  // Loaded from pipelineCachePath at startup and written back on destruction;
+  // warm when the file was there and made by this driver and GPU
+  VkPipelineCache pipelineCache() { return pipelineCache_; }
+  bool isPipelineCacheWarm() { return pipelineCacheWarm_; }
+  LvePipelineRegistry &pipelines() { return *pipelines_; }
+  LveAllocator &allocator() { return *allocator_; }
+  LveUploadContext &uploads() { return *uploads_; }
 
   SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice); }
   uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
@@ -52,23 +72,28 @@ class LveDevice {
       const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
   // Buffer Helper Functions
+  // Memory comes from the allocator, bound at allocation->offset; release with destroyBuffer
   void createBuffer(
       VkDeviceSize size,
       VkBufferUsageFlags usage,
       VkMemoryPropertyFlags properties,
       VkBuffer &buffer,
-      VkDeviceMemory &bufferMemory);
+      LveAllocation *&bufferAllocation);
+  void destroyBuffer(VkBuffer buffer, LveAllocation *bufferAllocation);
   VkCommandBuffer beginSingleTimeCommands();
   void endSingleTimeCommands(VkCommandBuffer commandBuffer);
-  void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
-  void copyBufferToImage(
+  // Batched through uploads(), the source has to stay alive until the ticket is done.
+  // copyBufferToImage moves the image to TRANSFER_DST_OPTIMAL itself.
+  LveUploadTicket copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+  LveUploadTicket copyBufferToImage(
       VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
 
   void createImageWithInfo(
       const VkImageCreateInfo &imageInfo,
       VkMemoryPropertyFlags properties,
       VkImage &image,
-      VkDeviceMemory &imageMemory);
+      LveAllocation *&imageAllocation);
+  void destroyImage(VkImage image, LveAllocation *imageAllocation);
 
   VkPhysicalDeviceProperties properties;
 
@@ -79,6 +104,9 @@ class LveDevice {
   void pickPhysicalDevice();
   void createLogicalDevice();
   void createCommandPool();
+  void createPipelineCache();
+  void savePipelineCache();
+  bool isPipelineCacheCompatible(const std::vector<char> &data);
 
   // helper functions
   bool isDeviceSuitable(VkPhysicalDevice device);
@@ -95,14 +123,23 @@ class LveDevice {
   VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
   LveWindow &window;
   VkCommandPool commandPool;
+  VkCommandPool transferCommandPool;
 
   VkDevice device_;
   VkSurfaceKHR surface_;
   VkQueue graphicsQueue_;
   VkQueue presentQueue_;
+  VkQueue transferQueue_;
+  uint32_t transferFamily_;
+  VkPipelineCache pipelineCache_;
+  bool pipelineCacheWarm_ = false;
+  std::unique_ptr<LvePipelineRegistry> pipelines_;
+  std::unique_ptr<LveAllocator> allocator_;
+  std::unique_ptr<LveUploadContext> uploads_;
 
   const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
   const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+  const std::string pipelineCachePath = "pipeline_cache.bin";
 };
 
 }  // namespace lve
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "lve_frame_scheduler.hpp"
+
+// std
+#include <algorithm>
+
+namespace lve {
+
+    double LveFrameScheduler::waitTimeout() const {
+        wakeups++;
+        if (!due()) {
+            return idleWait;
+        }
+        if (!rendered || minInterval() <= 0.0) {
+            return 0.0;
+        }
+        double elapsed = std::chrono::duration<double>(Clock::now() - lastFrame).count();
+        return std::clamp(minInterval() - elapsed, 0.0, idleWait);
+    }
+
+    bool LveFrameScheduler::beginFrame() {
+        if (!due()) {
+            return false;
+        }
+        Clock::time_point now = Clock::now();
+        if (rendered && std::chrono::duration<double>(now - lastFrame).count() < minInterval()) {
+            return false;
+        }
+        dirty = false;
+        frameStart = now;
+        return true;
+    }
+
+    void LveFrameScheduler::endFrame() {
+        busySeconds += std::chrono::duration<double>(Clock::now() - frameStart).count();
+        lastFrame = frameStart;
+        rendered = true;
+        frames++;
+    }
+
+    void LveFrameScheduler::takeUtilization(double &fps, double &busyPercent, uint64_t &wakeupCount) {
+        Clock::time_point now = Clock::now();
+        double wall = std::chrono::duration<double>(now - sampleStart).count();
+
+        fps = wall > 0.0 ? frames / wall : 0.0;
+        busyPercent = wall > 0.0 ? 100.0 * busySeconds / wall : 0.0;
+        wakeupCount = wakeups;
+
+        sampleStart = now;
+        busySeconds = 0.0;
+        frames = 0;
+        wakeups = 0;
+    }
+} // namespace lve
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace lve {
+
+    // Renders only when something changed (invalidate) or the scene animates (continuous).
+    // In between, the loop sleeps in glfwWaitEventsTimeout for waitTimeout() seconds.
+    // Unfocused windows are capped to unfocusedHz and minimized ones never render.
+    class LveFrameScheduler {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            void invalidate() { dirty = true; }
+            void setContinuous(bool animating) { continuous = animating; }
+            void setFocused(bool value) { focused = value; }
+            void setMinimized(bool value) { minimized = value; }
+
+            // 0 = a frame is due right now
+            double waitTimeout() const;
+
+            bool beginFrame();
+            void endFrame();
+
+            // fps and share of wall time spent inside frames since the last call
+            void takeUtilization(double &fps, double &busyPercent, uint64_t &wakeups);
+
+            double unfocusedHz = 10.0;
+            double idleWait = 0.25; // seconds, keeps the loop responsive to shouldClose
+        private:
+            bool due() const { return !minimized && (dirty || continuous); }
+            double minInterval() const { return focused ? 0.0 : 1.0 / unfocusedHz; }
+
+            bool dirty = true;
+            bool continuous = false;
+            bool focused = true;
+            bool minimized = false;
+
+            bool rendered = false;
+            Clock::time_point lastFrame{};
+            Clock::time_point frameStart{};
+
+            Clock::time_point sampleStart = Clock::now();
+            double busySeconds = 0.0;
+            uint64_t frames = 0;
+            mutable uint64_t wakeups = 0;
+    };
+} // namespace lve
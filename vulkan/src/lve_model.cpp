@@ -0,0 +1,93 @@
+#include "lve_model.hpp"
+
+// std headers
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+namespace lve {
+
+std::vector<VkVertexInputBindingDescription> LveModel::Vertex::getBindingDescriptions() {
+  std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+  bindingDescriptions[0].binding = 0;
+  bindingDescriptions[0].stride = sizeof(Vertex);
+  bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+  return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> LveModel::Vertex::getAttributeDescriptions() {
+  std::vector<VkVertexInputAttributeDescription> attributeDescriptions(1);
+  attributeDescriptions[0].binding = 0;
+  attributeDescriptions[0].location = 0;
+  attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+  attributeDescriptions[0].offset = offsetof(Vertex, position);
+  return attributeDescriptions;
+}
+
+LveModel::LveModel(
+    LveDevice &device, const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices)
+    : lveDevice{device},
+      vertexCount{static_cast<uint32_t>(vertices.size())},
+      indexCount{static_cast<uint32_t>(indices.size())} {
+  if (vertexCount < 3) {
+    throw std::runtime_error("a model needs at least 3 vertices!");
+  }
+  createBuffer(
+      vertices.data(),
+      sizeof(vertices[0]) * vertexCount,
+      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+      vertexBuffer,
+      vertexAllocation);
+  if (indexCount > 0) {
+    createBuffer(
+        indices.data(),
+        sizeof(indices[0]) * indexCount,
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        indexBuffer,
+        indexAllocation);
+  }
+}
+
+LveModel::~LveModel() {
+  // the copies may still be reading into the buffers
+  lveDevice.uploads().wait(uploadTicket_);
+  lveDevice.destroyBuffer(vertexBuffer, vertexAllocation);
+  if (indexBuffer != VK_NULL_HANDLE) {
+    lveDevice.destroyBuffer(indexBuffer, indexAllocation);
+  }
+}
+
+void LveModel::createBuffer(
+    const void *data,
+    VkDeviceSize size,
+    VkBufferUsageFlags usage,
+    VkBuffer &buffer,
+    LveAllocation *&allocation) {
+  lveDevice.createBuffer(
+      size,
+      usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      buffer,
+      allocation);
+  // staged in the upload ring, data can go away as soon as this returns
+  uploadTicket_ = std::max(uploadTicket_, lveDevice.uploads().uploadBuffer(buffer, 0, data, size));
+}
+
+void LveModel::bind(VkCommandBuffer commandBuffer) {
+  VkBuffer buffers[] = {vertexBuffer};
+  VkDeviceSize offsets[] = {0};
+  vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+  if (indexBuffer != VK_NULL_HANDLE) {
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+  }
+}
+
+void LveModel::draw(VkCommandBuffer commandBuffer) {
+  if (indexBuffer != VK_NULL_HANDLE) {
+    vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+  } else {
+    vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+  }
+}
+
+}  // namespace lve
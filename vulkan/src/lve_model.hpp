@@ -0,0 +1,57 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+// Vertex and (optional) index buffer in device local memory. The data goes through the
+// device's upload context, so creating a batch of models records their copies into one
+// submission instead of a queue round trip each. The copies go out with the next
+// uploads().flush(), which has to be submitted before any command buffer drawing the model.
+class LveModel {
+ public:
+  struct Vertex {
+    float position[2];
+
+    static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
+    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+  };
+
+  LveModel(
+      LveDevice &device,
+      const std::vector<Vertex> &vertices,
+      const std::vector<uint32_t> &indices = {});
+  ~LveModel();
+
+  LveModel(const LveModel &) = delete;
+  LveModel &operator=(const LveModel &) = delete;
+
+  void bind(VkCommandBuffer commandBuffer);
+  void draw(VkCommandBuffer commandBuffer);
+
+  // Done once the buffers hold their data and belong to the graphics queue
+  LveUploadTicket uploadTicket() const { return uploadTicket_; }
+
+ private:
+  void createBuffer(
+      const void *data,
+      VkDeviceSize size,
+      VkBufferUsageFlags usage,
+      VkBuffer &buffer,
+      LveAllocation *&allocation);
+
+  LveDevice &lveDevice;
+  VkBuffer vertexBuffer = VK_NULL_HANDLE;
+  LveAllocation *vertexAllocation = nullptr;
+  uint32_t vertexCount;
+  VkBuffer indexBuffer = VK_NULL_HANDLE;
+  LveAllocation *indexAllocation = nullptr;
+  uint32_t indexCount;
+  LveUploadTicket uploadTicket_ = 0;
+};
+
+}  // namespace lve
@@ -1,9 +1,5 @@
 #include "lve_pipeline.hpp"
-
-#include <fstream>
-#include <stdexcept>
-#include <iostream>
-#include <cassert>
+#include "lve_pipeline_registry.hpp"
 
 namespace lve {
 
@@ -12,123 +8,35 @@ namespace lve {
                 const std::string& vertFilepath, 
                 const std::string& fragFilepath, 
                 const PipelineConfigInfo &configInfo) : lveDevice(device) {
-        createGraphicsPipeline(vertFilepath, fragFilepath, configInfo);
-    }
-
-    LvePipeline::~LvePipeline() {
-        vkDestroyShaderModule(lveDevice.device(), vertexShaderModule, nullptr);
-        vkDestroyShaderModule(lveDevice.device(), fragShaderModule, nullptr);
-        vkDestroyPipeline(lveDevice.device(), graphicsPipeLine, nullptr);
+        graphicsPipeLine = lveDevice.pipelines().getPipeline(vertFilepath, fragFilepath, configInfo);
     }
-    
-    // just reads the glsg files as a binary instead of text
-    std::vector<char> LvePipeline::readFile(const std::string& filepath) {
-        std::ifstream file{filepath, std::ios::ate | std::ios::binary}; //std::ios::ate and std::ios::binary are bit flags
-        
-        if (!file.is_open()) {
-            throw std::runtime_error("Failed to open file : " + filepath);
-        }
-
-        size_t filesize = static_cast<size_t>(file.tellg());
-        std::vector<char> buffer(filesize);
-
-        file.seekg(0); // goes to the start of the file
-        file.read(buffer.data(), filesize); // reads the file
-
-        file.close();
-        return buffer;
-    };
-
-    void LvePipeline::createGraphicsPipeline(
-        const std::string& vertFilepath, const std::string& fragFilepath, const PipelineConfigInfo& configInfo) {
-
-            // Reads shader files from disk
-            auto vertCode = readFile(vertFilepath);
-            auto fragCode = readFile(fragFilepath);
 
-            assert(configInfo.pipelineLayout != VK_NULL_HANDLE && 
-                "cannot create graphics pipeline:: no pipelineLayout provided in configinfo");
+    // the registry destroys the pipeline and shader modules once nothing uses them anymore
+    LvePipeline::~LvePipeline() = default;
 
-            assert(configInfo.renderPass != VK_NULL_HANDLE && 
-                "cannot create graphics pipeline:: no pipelineLayout provided in configinfo");
-            // Creates vulkan shader modules
-            // Shaders on disk are useless until you wrap them into VKshaderModule objects
-            // These shader modules:
-            // get owned by the GPU
-            // Stays alive aslong as the piepline needs them
-            // must be destroyed after pipeline creation is finished
-            // We are basically giving the bytecode to vulkan and asking it to prepare it
-            createShaderModule(vertCode, &vertexShaderModule);
-            createShaderModule(fragCode, &fragShaderModule);
-
-/*
-            # This array holds two shader stages
-             -> vertex shader
-             -> fragment shader
-            # Now we populate them
-*/          VkPipelineShaderStageCreateInfo shaderStages[2];
-            shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-            shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-            shaderStages[0].module = vertexShaderModule;
-            shaderStages[0].pName = "main";
-            shaderStages[0].flags = 0;
-            shaderStages[0].pNext = nullptr;
-            shaderStages[0].pSpecializationInfo = nullptr;
-
-            shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-            shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-            shaderStages[1].module = fragShaderModule;
-            shaderStages[1].pName = "main";
-            shaderStages[1].flags = 0;
-            shaderStages[1].pNext = nullptr;
-            shaderStages[1].pSpecializationInfo = nullptr;
-
-            // This struct is used to describe how we interpret our input vertex buffer data that is the initial input to the graphics pipeline
-            VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-            vertexInputInfo.vertexAttributeDescriptionCount = 0;
-            vertexInputInfo.vertexBindingDescriptionCount = 0;
-            vertexInputInfo.pVertexAttributeDescriptions = nullptr;
-            vertexInputInfo.pVertexBindingDescriptions = nullptr;
-
-            // This struct will use all the above config we went through to create our actual graphics pipeline object
-            VkGraphicsPipelineCreateInfo pipelineInfo{};
-            pipelineInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-            pipelineInfo.stageCount = 2; // stage count specifies how many programmable stages our pipeline will use. (we have vertex and fragment shaders for now)
-            pipelineInfo.pStages = shaderStages;
-            pipelineInfo.pVertexInputState = &vertexInputInfo;
-            pipelineInfo.pInputAssemblyState = &configInfo.inputAssemblyInfo;
-            pipelineInfo.pViewportState = &configInfo.viewportInfo;
-            pipelineInfo.pRasterizationState= &configInfo.rasterizationInfo;
-            pipelineInfo.pMultisampleState = &configInfo.multisampleInfo;
-            pipelineInfo.pColorBlendState = &configInfo.colorBlendInfo;
-            pipelineInfo.pDepthStencilState= &configInfo.depthStencilInfo;
-            pipelineInfo.pDynamicState = nullptr;
-
-            pipelineInfo.layout = configInfo.pipelineLayout;
-            pipelineInfo.renderPass = configInfo.renderPass;
-            pipelineInfo.subpass = configInfo.subpass;
-
-            // These can be used to optimize performance
-            pipelineInfo.basePipelineIndex = -1;
-            pipelineInfo.basePipelineHandle =  VK_NULL_HANDLE;
-
-            if (vkCreateGraphicsPipelines(lveDevice.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeLine) != VK_SUCCESS) {
-                throw std::runtime_error("Failed to create a graphics pipeline");
-            }
+    VkPipeline LvePipeline::handle() const {
+        return graphicsPipeLine->pipeline;
     }
 
-    void LvePipeline::createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule) {
-        VkShaderModuleCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = code.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+    void LvePipeline::bind(VkCommandBuffer commandBuffer) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeLine->pipeline);
+    }
 
-        if (vkCreateShaderModule(lveDevice.device(), &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create a shader module");
-        }
+    void LvePipeline::setViewport(VkCommandBuffer commandBuffer, VkExtent2D extent) {
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = static_cast<float>(extent.width);
+        viewport.height = static_cast<float>(extent.height);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+        VkRect2D scissor{{0, 0}, extent};
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
     }
 
-    PipelineConfigInfo LvePipeline::defaultPipelineConfigInfo(uint32_t width, uint32_t height) {
+    PipelineConfigInfo LvePipeline::defaultPipelineConfigInfo() {
         PipelineConfigInfo configInfo{};
 
         // this is the first stage of the pipeline and takes input a group of vertices and groups them into geometry
@@ -141,23 +49,16 @@ namespace lve {
         // Viewport + scissor
         // viewport = "transform normalized device coordinates into pixel coords"
         // scissor = "only draw inside this rectangle; clip everything outside"
-        configInfo.viewport.x = 0.0f;
-        configInfo.viewport.y = 0.0f;
-        configInfo.viewport.width = static_cast<float>(width);
-        configInfo.viewport.height = static_cast<float>(height);
-        configInfo.viewport.minDepth = 0.0f;
-        configInfo.viewport.maxDepth = 1.0f;
-        // scissor
-        configInfo.scissor.offset = {0, 0};
-        configInfo.scissor.extent = {width, height};
+        // Both are dynamic, set while recording, so resizing doesn't need new pipelines
+        configInfo.dynamicStateEnables = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
         
         // ViewPort state
         // We tell vulkan we have exactly one viewport and one scissor
         configInfo.viewportInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
         configInfo.viewportInfo.viewportCount = 1;
-        configInfo.viewportInfo.pViewports = &configInfo.viewport;
+        configInfo.viewportInfo.pViewports = nullptr;
         configInfo.viewportInfo.scissorCount = 1;
-        configInfo.viewportInfo.pScissors = &configInfo.scissor;
+        configInfo.viewportInfo.pScissors = nullptr;
         
         // Rasterize
         configInfo.rasterizationInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -3,14 +3,15 @@
 #include "lve_device.hpp"
 
 //std
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace lve {
 
     struct PipelineConfigInfo {
-        VkViewport viewport;
-        VkRect2D scissor;
+        VkViewport viewport;  // only used when not in dynamicStateEnables
+        VkRect2D scissor;     // same
         VkPipelineViewportStateCreateInfo viewportInfo;
         VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo;
         VkPipelineRasterizationStateCreateInfo rasterizationInfo;
@@ -18,6 +19,10 @@ namespace lve {
         VkPipelineColorBlendAttachmentState colorBlendAttachment;
         VkPipelineColorBlendStateCreateInfo colorBlendInfo;
         VkPipelineDepthStencilStateCreateInfo depthStencilInfo;
+        // Set with vkCmdSet* while recording instead of being baked into the pipeline, and left
+        // out of the registry's pipeline key. Core 1.0 states only, LveDevice enables no
+        // dynamic state extensions.
+        std::vector<VkDynamicState> dynamicStateEnables;
         VkPipelineLayout pipelineLayout = nullptr;
         VkRenderPass renderPass = nullptr;
         uint32_t subpass = 0;
@@ -26,8 +31,12 @@ namespace lve {
             // our application layer code to be easily able to configure our pipeline completely as well as share the configuration with other pipelines
     };
 
+    struct LveSharedPipeline;
+
     class LvePipeline {
         public:
+            // Shares the shader modules and pipeline with any other LvePipeline of the same
+            // shaders and config, see LvePipelineRegistry
             LvePipeline(
                 LveDevice &device, 
                 const std::string& vertFilepath, 
@@ -40,21 +49,18 @@ namespace lve {
             LvePipeline(const LvePipeline&) = delete;
             void operator&(const LvePipeline&) = delete;
 
-            static PipelineConfigInfo defaultPipelineConfigInfo(uint32_t width, uint32_t height);
+            VkPipeline handle() const;
+            void bind(VkCommandBuffer commandBuffer);
+
+            // Viewport and scissor are dynamic, so one pipeline works for any framebuffer size;
+            // set them with setViewport() after binding. For a fixed size instead, fill in
+            // viewport and scissor and take them out of dynamicStateEnables.
+            static PipelineConfigInfo defaultPipelineConfigInfo();
+            // Full framebuffer viewport and scissor, for pipelines with them dynamic
+            static void setViewport(VkCommandBuffer commandBuffer, VkExtent2D extent);
         
         private:
-            static std::vector<char> readFile(const std::string& filepath);
-
-            void createGraphicsPipeline(
-                const std::string& vertFilepath, 
-                const std::string& fragFilepath,
-                const PipelineConfigInfo& confInfo);
-
-            void createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
-
             LveDevice& lveDevice;  // stores the device reference
-            VkPipeline graphicsPipeLine;
-            VkShaderModule vertexShaderModule;
-            VkShaderModule fragShaderModule;
+            std::shared_ptr<const LveSharedPipeline> graphicsPipeLine;
     };
 }
\ No newline at end of file
@@ -0,0 +1,596 @@
+#include "lve_pipeline_registry.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace lve {
+
+    namespace {
+        template <typename T>
+        void append(std::string& key, const T& value) {
+            key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        // Reading a key grows the list to the count it holds, real configs have a handful
+        constexpr uint32_t maxDynamicStates = 32;
+
+        void resizeTo(const std::vector<VkDynamicState>&, uint32_t) {}
+        void resizeTo(std::vector<VkDynamicState>& states, uint32_t count) {
+            states.resize(std::min(count, maxDynamicStates));
+        }
+
+        bool isDynamic(const std::vector<VkDynamicState>& states, VkDynamicState state) {
+            return std::find(states.begin(), states.end(), state) != states.end();
+        }
+
+        template <typename Stencil, typename Fn>
+        void forEachStencilField(Stencil& op, Fn&& field) {
+            field(op.failOp);
+            field(op.passOp);
+            field(op.depthFailOp);
+            field(op.compareOp);
+            field(op.compareMask);
+            field(op.writeMask);
+            field(op.reference);
+        }
+
+        // Field by field, the structs have padding and pointers into the config itself.
+        // Both the pipeline keys and the manifest go through this, so it works on const and
+        // non const configs alike.
+        template <typename Config, typename Fn>
+        void forEachStateField(Config& configInfo, Fn&& field) {
+            // Dynamic state goes first: what is set at record time is left out, so pipelines
+            // that only differ in it are the same pipeline, and reading has to know the list
+            // before it gets to those fields
+            auto& dynamicStates = configInfo.dynamicStateEnables;
+            uint32_t dynamicCount = static_cast<uint32_t>(dynamicStates.size());
+            field(dynamicCount);
+            resizeTo(dynamicStates, dynamicCount);
+            for (auto& state : dynamicStates) {
+                field(state);
+            }
+
+            if (!isDynamic(dynamicStates, VK_DYNAMIC_STATE_VIEWPORT)) {
+                auto& viewport = configInfo.viewport;
+                field(viewport.x);
+                field(viewport.y);
+                field(viewport.width);
+                field(viewport.height);
+                field(viewport.minDepth);
+                field(viewport.maxDepth);
+            }
+            if (!isDynamic(dynamicStates, VK_DYNAMIC_STATE_SCISSOR)) {
+                field(configInfo.scissor.offset.x);
+                field(configInfo.scissor.offset.y);
+                field(configInfo.scissor.extent.width);
+                field(configInfo.scissor.extent.height);
+            }
+            field(configInfo.viewportInfo.viewportCount);
+            field(configInfo.viewportInfo.scissorCount);
+
+            auto& inputAssembly = configInfo.inputAssemblyInfo;
+            field(inputAssembly.topology);
+            field(inputAssembly.primitiveRestartEnable);
+
+            auto& raster = configInfo.rasterizationInfo;
+            field(raster.depthClampEnable);
+            field(raster.rasterizerDiscardEnable);
+            field(raster.polygonMode);
+            field(raster.cullMode);
+            field(raster.frontFace);
+            field(raster.depthBiasEnable);
+            if (!isDynamic(dynamicStates, VK_DYNAMIC_STATE_DEPTH_BIAS)) {
+                field(raster.depthBiasConstantFactor);
+                field(raster.depthBiasClamp);
+                field(raster.depthBiasSlopeFactor);
+            }
+            if (!isDynamic(dynamicStates, VK_DYNAMIC_STATE_LINE_WIDTH)) {
+                field(raster.lineWidth);
+            }
+
+            // pSampleMask is left out, nothing sets one
+            auto& multisample = configInfo.multisampleInfo;
+            field(multisample.rasterizationSamples);
+            field(multisample.sampleShadingEnable);
+            field(multisample.minSampleShading);
+            field(multisample.alphaToCoverageEnable);
+            field(multisample.alphaToOneEnable);
+
+            auto& attachment = configInfo.colorBlendAttachment;
+            field(attachment.blendEnable);
+            field(attachment.srcColorBlendFactor);
+            field(attachment.dstColorBlendFactor);
+            field(attachment.colorBlendOp);
+            field(attachment.srcAlphaBlendFactor);
+            field(attachment.dstAlphaBlendFactor);
+            field(attachment.alphaBlendOp);
+            field(attachment.colorWriteMask);
+
+            auto& blend = configInfo.colorBlendInfo;
+            field(blend.logicOpEnable);
+            field(blend.logicOp);
+            field(blend.attachmentCount);
+            field(blend.blendConstants);
+
+            auto& depth = configInfo.depthStencilInfo;
+            field(depth.depthTestEnable);
+            field(depth.depthWriteEnable);
+            field(depth.depthCompareOp);
+            field(depth.depthBoundsTestEnable);
+            field(depth.stencilTestEnable);
+            forEachStencilField(depth.front, field);
+            forEachStencilField(depth.back, field);
+            field(depth.minDepthBounds);
+            field(depth.maxDepthBounds);
+        }
+
+        std::string toHex(const std::string& bytes) {
+            static const char digits[] = "0123456789abcdef";
+            std::string hex;
+            hex.reserve(bytes.size() * 2);
+            for (unsigned char c : bytes) {
+                hex += digits[c >> 4];
+                hex += digits[c & 15];
+            }
+            return hex;
+        }
+
+        bool fromHex(const std::string& hex, std::string& bytes) {
+            if (hex.size() % 2 != 0) return false;
+            bytes.clear();
+            for (size_t i = 0; i < hex.size(); i += 2) {
+                unsigned value;
+                if (std::sscanf(hex.c_str() + i, "%2x", &value) != 1) return false;
+                bytes += static_cast<char>(value);
+            }
+            return true;
+        }
+
+        uint64_t handleBits(const void* handle) {
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+        }
+    }
+
+    LvePipelineRegistry::LvePipelineRegistry(LveDevice &device) : lveDevice(device) {}
+
+    LvePipelineRegistry::~LvePipelineRegistry() {
+        waitForWarmUp();
+        saveManifest();
+    }
+
+    // just reads the glsg files as a binary instead of text
+    std::vector<char> LvePipelineRegistry::readFile(const std::string& filepath) {
+        std::ifstream file{filepath, std::ios::ate | std::ios::binary}; //std::ios::ate and std::ios::binary are bit flags
+
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open file : " + filepath);
+        }
+
+        size_t filesize = static_cast<size_t>(file.tellg());
+        std::vector<char> buffer(filesize);
+
+        file.seekg(0); // goes to the start of the file
+        file.read(buffer.data(), filesize); // reads the file
+
+        file.close();
+        return buffer;
+    }
+
+    std::string LvePipelineRegistry::stateKey(const PipelineConfigInfo& configInfo) {
+        std::string key;
+        key.reserve(256);
+        forEachStateField(configInfo, [&key](const auto& value) { append(key, value); });
+        return key;
+    }
+
+    bool LvePipelineRegistry::readStateKey(const std::string& key, PipelineConfigInfo& configInfo) {
+        size_t offset = 0;
+        bool complete = true;
+        forEachStateField(configInfo, [&](auto& value) {
+            if (offset + sizeof(value) > key.size()) {
+                complete = false;
+                return;
+            }
+            std::memcpy(&value, key.data() + offset, sizeof(value));
+            offset += sizeof(value);
+        });
+        return complete && offset == key.size();
+    }
+
+    LvePipelineRegistry::ModuleRef LvePipelineRegistry::getShaderModule(const std::string& filepath) {
+        counters.shaderModuleRequests++;
+        return loadShaderModule(filepath);
+    }
+
+    LvePipelineRegistry::ModuleRef LvePipelineRegistry::loadShaderModule(const std::string& filepath) {
+        auto code = readFile(filepath);
+        std::string spirv(code.begin(), code.end());
+        if (auto module = shaderModules[spirv].lock()) {
+            return module;
+        }
+
+        // Creates vulkan shader modules
+        // Shaders on disk are useless until you wrap them into VKshaderModule objects
+        // We are basically giving the bytecode to vulkan and asking it to prepare it
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = code.size();
+        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+        VkShaderModule shaderModule;
+        if (vkCreateShaderModule(lveDevice.device(), &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create a shader module");
+        }
+
+        VkDevice device = lveDevice.device();
+        auto module = std::shared_ptr<LveShaderModule>(new LveShaderModule{shaderModule, nextModuleId++},
+            [device](LveShaderModule* m) {
+                vkDestroyShaderModule(device, m->module, nullptr);
+                delete m;
+            });
+        shaderModules[spirv] = module;
+        counters.uniqueShaderModules++;
+        return module;
+    }
+
+    LvePipelineRegistry::Request LvePipelineRegistry::makeRequest(
+        ModuleRef vertModule, ModuleRef fragModule, const PipelineConfigInfo& configInfo) {
+            Request request;
+            request.configInfo = configInfo;
+
+            // shaders, layout and render pass decide the family, the fixed function state the variant
+            append(request.familyKey, vertModule->id);
+            append(request.familyKey, fragModule->id);
+            append(request.familyKey, handleBits(configInfo.pipelineLayout));
+            append(request.familyKey, handleBits(configInfo.renderPass));
+            append(request.familyKey, configInfo.subpass);
+            request.key = request.familyKey + stateKey(configInfo);
+
+            request.vertModule = std::move(vertModule);
+            request.fragModule = std::move(fragModule);
+            return request;
+    }
+
+    std::shared_ptr<const LveSharedPipeline> LvePipelineRegistry::getPipeline(
+        const std::string& vertFilepath,
+        const std::string& fragFilepath,
+        const PipelineConfigInfo& configInfo) {
+
+            assert(configInfo.pipelineLayout != VK_NULL_HANDLE && 
+                "cannot create graphics pipeline:: no pipelineLayout provided in configinfo");
+
+            assert(configInfo.renderPass != VK_NULL_HANDLE && 
+                "cannot create graphics pipeline:: no pipelineLayout provided in configinfo");
+
+            std::unique_lock<std::mutex> lock(mutex);
+            counters.pipelineRequests++;
+            record(vertFilepath, fragFilepath, configInfo);
+            Request request = makeRequest(getShaderModule(vertFilepath), getShaderModule(fragFilepath), configInfo);
+
+            if (auto pipeline = pipelines[request.key].lock()) {
+                return pipeline;
+            }
+            auto building = pending.find(request.key);
+            if (building != pending.end()) {
+                // warmUp() is on it already, waiting beats compiling it a second time
+                counters.warmUpWaits++;
+                std::shared_future<PipelineRef> future = building->second;
+                lock.unlock();
+                return future.get();
+            }
+
+            std::promise<PipelineRef> promise;
+            pending[request.key] = promise.get_future().share();
+            return build(lock, request, promise);
+    }
+
+    LvePipelineRegistry::PipelineRef LvePipelineRegistry::build(
+        std::unique_lock<std::mutex>& lock, const Request& request, std::promise<PipelineRef>& promise) {
+            // a variant queued before its base is built stands on its own
+            auto base = families[request.familyKey].lock();
+            lock.unlock();
+
+            VkPipeline handle;
+            double createMs = 0.0;
+            try {
+                handle = createGraphicsPipeline(
+                    request.configInfo,
+                    request.vertModule->module,
+                    request.fragModule->module,
+                    base ? base->pipeline : VK_NULL_HANDLE,
+                    createMs);
+            } catch (...) {
+                lock.lock();
+                pending.erase(request.key);
+                promise.set_exception(std::current_exception());
+                throw;
+            }
+
+            VkDevice device = lveDevice.device();
+            auto pipeline = std::shared_ptr<LveSharedPipeline>(
+                new LveSharedPipeline{handle, request.vertModule, request.fragModule, base != nullptr},
+                [device](LveSharedPipeline* p) {
+                    vkDestroyPipeline(device, p->pipeline, nullptr);
+                    delete p;
+                });
+
+            lock.lock();
+            pipelines[request.key] = pipeline;
+            pending.erase(request.key);
+            if (!base) {
+                families[request.familyKey] = pipeline;
+            } else {
+                counters.derivedPipelines++;
+            }
+            counters.uniquePipelines++;
+            counters.createMs += createMs;
+            promise.set_value(pipeline);
+            return pipeline;
+    }
+
+    void LvePipelineRegistry::record(
+        const std::string& vertFilepath, const std::string& fragFilepath, const PipelineConfigInfo& configInfo) {
+            auto indexOf = [](auto& seen, auto handle) {
+                auto it = std::find(seen.begin(), seen.end(), handle);
+                if (it == seen.end()) {
+                    seen.push_back(handle);
+                    return seen.size() - 1;
+                }
+                return static_cast<size_t>(it - seen.begin());
+            };
+
+            std::ostringstream line;
+            line << vertFilepath << '\t' << fragFilepath << '\t'
+                 << indexOf(seenLayouts, configInfo.pipelineLayout) << '\t'
+                 << indexOf(seenRenderPasses, configInfo.renderPass) << '\t'
+                 << configInfo.subpass << '\t' << toHex(stateKey(configInfo));
+            if (manifestLines.insert(line.str()).second) {
+                manifest.push_back(line.str());
+            }
+    }
+
+    void LvePipelineRegistry::saveManifest() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (manifest.empty()) {
+            return;
+        }
+
+        // same as the pipeline cache: write a new file, then rename it over the old one
+        std::string tmpPath = manifestPath + ".tmp";
+        {
+            std::ofstream file{tmpPath, std::ios::trunc};
+            for (const std::string& line : manifest) {
+                file << line << '\n';
+            }
+            if (!file.flush()) {
+                std::cerr << "pipeline manifest: failed to write " << tmpPath << std::endl;
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(tmpPath, manifestPath, error);
+        if (error) {
+            std::cerr << "pipeline manifest: failed to replace " << manifestPath << ": " << error.message() << std::endl;
+            std::filesystem::remove(tmpPath, error);
+        }
+    }
+
+    void LvePipelineRegistry::warmUp(
+        const std::vector<VkPipelineLayout>& layouts,
+        const std::vector<VkRenderPass>& renderPasses,
+        unsigned threadCount) {
+            waitForWarmUp();
+
+            std::ifstream file{manifestPath};
+            if (!file.is_open()) {
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            warmUpStart = std::chrono::steady_clock::now();
+            warmUpQueue.clear();
+            warmUpPromises.clear();
+            warmUpNext = 0;
+
+            std::string line;
+            while (std::getline(file, line)) {
+                std::istringstream fields(line);
+                std::string vertFilepath, fragFilepath, hex, state;
+                size_t layoutIndex, renderPassIndex;
+                uint32_t subpass;
+                if (!std::getline(fields, vertFilepath, '\t') || !std::getline(fields, fragFilepath, '\t') ||
+                    !(fields >> layoutIndex >> renderPassIndex >> subpass >> hex) ||
+                    layoutIndex >= layouts.size() || renderPassIndex >= renderPasses.size()) {
+                    continue;
+                }
+
+                // the default config for the sTypes, everything that matters comes from the manifest
+                PipelineConfigInfo configInfo = LvePipeline::defaultPipelineConfigInfo();
+                if (!fromHex(hex, state) || !readStateKey(state, configInfo)) {
+                    continue;
+                }
+                configInfo.pipelineLayout = layouts[layoutIndex];
+                configInfo.renderPass = renderPasses[renderPassIndex];
+                configInfo.subpass = subpass;
+
+                Request request;
+                try {
+                    request = makeRequest(loadShaderModule(vertFilepath), loadShaderModule(fragFilepath), configInfo);
+                } catch (const std::exception&) {
+                    continue; // shaders that are gone since the last run
+                }
+                if (!pipelines[request.key].expired() || pending.count(request.key)) {
+                    continue;
+                }
+                // marked pending right away, so getPipeline() waits instead of racing the workers
+                warmUpPromises.emplace_back();
+                pending[request.key] = warmUpPromises.back().get_future().share();
+                warmUpQueue.push_back(std::move(request));
+            }
+
+            counters.warmUpPipelines = warmUpQueue.size();
+            counters.warmUpReady = 0;
+            counters.warmUpMs = 0.0;
+            if (warmUpQueue.empty()) {
+                return;
+            }
+
+            if (threadCount == 0) {
+                unsigned cores = std::thread::hardware_concurrency();
+                threadCount = cores > 1 ? cores - 1 : 1;
+            }
+            threadCount = std::min<unsigned>(threadCount, static_cast<unsigned>(warmUpQueue.size()));
+            for (unsigned i = 0; i < threadCount; i++) {
+                warmUpThreads.emplace_back(&LvePipelineRegistry::warmUpWorker, this);
+            }
+    }
+
+    // vkCreateGraphicsPipelines may run on several threads at once, pipeline caches are
+    // internally synchronized unless created with the externally synchronized flag
+    void LvePipelineRegistry::warmUpWorker() {
+        for (size_t i = warmUpNext++; i < warmUpQueue.size(); i = warmUpNext++) {
+            std::unique_lock<std::mutex> lock(mutex);
+            PipelineRef pipeline;
+            try {
+                pipeline = build(lock, warmUpQueue[i], warmUpPromises[i]);
+            } catch (const std::exception& e) {
+                if (!lock.owns_lock()) lock.lock();
+                std::cerr << "pipeline warm-up: " << e.what() << std::endl;
+            }
+
+            if (pipeline) {
+                warmed.push_back(pipeline);
+            }
+            if (++counters.warmUpReady == warmUpQueue.size()) {
+                counters.warmUpMs = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - warmUpStart).count();
+            }
+        }
+    }
+
+    bool LvePipelineRegistry::isWarmUpDone() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return counters.warmUpReady == counters.warmUpPipelines;
+    }
+
+    void LvePipelineRegistry::waitForWarmUp() {
+        for (std::thread& thread : warmUpThreads) {
+            thread.join();
+        }
+        warmUpThreads.clear();
+    }
+
+    VkPipeline LvePipelineRegistry::createGraphicsPipeline(
+        const PipelineConfigInfo& configInfo,
+        VkShaderModule vertModule,
+        VkShaderModule fragModule,
+        VkPipeline basePipeline,
+        double& createMs) {
+/*
+            # This array holds two shader stages
+             -> vertex shader
+             -> fragment shader
+            # Now we populate them
+*/          VkPipelineShaderStageCreateInfo shaderStages[2];
+            shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+            shaderStages[0].module = vertModule;
+            shaderStages[0].pName = "main";
+            shaderStages[0].flags = 0;
+            shaderStages[0].pNext = nullptr;
+            shaderStages[0].pSpecializationInfo = nullptr;
+
+            shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+            shaderStages[1].module = fragModule;
+            shaderStages[1].pName = "main";
+            shaderStages[1].flags = 0;
+            shaderStages[1].pNext = nullptr;
+            shaderStages[1].pSpecializationInfo = nullptr;
+
+            // This struct is used to describe how we interpret our input vertex buffer data that is the initial input to the graphics pipeline
+            VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+            vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+            vertexInputInfo.vertexAttributeDescriptionCount = 0;
+            vertexInputInfo.vertexBindingDescriptionCount = 0;
+            vertexInputInfo.pVertexAttributeDescriptions = nullptr;
+            vertexInputInfo.pVertexBindingDescriptions = nullptr;
+
+            // the config is copied around by value, point the viewport state at this copy's members
+            const auto& dynamicStates = configInfo.dynamicStateEnables;
+            VkPipelineViewportStateCreateInfo viewportInfo = configInfo.viewportInfo;
+            viewportInfo.pViewports = isDynamic(dynamicStates, VK_DYNAMIC_STATE_VIEWPORT) ? nullptr : &configInfo.viewport;
+            viewportInfo.pScissors = isDynamic(dynamicStates, VK_DYNAMIC_STATE_SCISSOR) ? nullptr : &configInfo.scissor;
+            VkPipelineColorBlendStateCreateInfo colorBlendInfo = configInfo.colorBlendInfo;
+            colorBlendInfo.pAttachments = &configInfo.colorBlendAttachment;
+
+            // State that is set while recording instead of baked in
+            VkPipelineDynamicStateCreateInfo dynamicStateInfo{};
+            dynamicStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+            dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+            dynamicStateInfo.pDynamicStates = dynamicStates.data();
+
+            // This struct will use all the above config we went through to create our actual graphics pipeline object
+            VkGraphicsPipelineCreateInfo pipelineInfo{};
+            pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+            pipelineInfo.stageCount = 2; // stage count specifies how many programmable stages our pipeline will use. (we have vertex and fragment shaders for now)
+            pipelineInfo.pStages = shaderStages;
+            pipelineInfo.pVertexInputState = &vertexInputInfo;
+            pipelineInfo.pInputAssemblyState = &configInfo.inputAssemblyInfo;
+            pipelineInfo.pViewportState = &viewportInfo;
+            pipelineInfo.pRasterizationState= &configInfo.rasterizationInfo;
+            pipelineInfo.pMultisampleState = &configInfo.multisampleInfo;
+            pipelineInfo.pColorBlendState = &colorBlendInfo;
+            pipelineInfo.pDepthStencilState= &configInfo.depthStencilInfo;
+            pipelineInfo.pDynamicState = dynamicStates.empty() ? nullptr : &dynamicStateInfo;
+
+            pipelineInfo.layout = configInfo.pipelineLayout;
+            pipelineInfo.renderPass = configInfo.renderPass;
+            pipelineInfo.subpass = configInfo.subpass;
+
+            // Every pipeline may become the base of its variants, variants start from their base
+            pipelineInfo.flags = VK_PIPELINE_CREATE_ALLOW_DERIVATIVES_BIT;
+            if (basePipeline != VK_NULL_HANDLE) {
+                pipelineInfo.flags |= VK_PIPELINE_CREATE_DERIVATIVE_BIT;
+            }
+            pipelineInfo.basePipelineIndex = -1;
+            pipelineInfo.basePipelineHandle = basePipeline;
+
+            // the device's cache remembers compiled pipelines across runs, so only the first launch pays for compiling
+            auto start = std::chrono::steady_clock::now();
+            VkPipeline graphicsPipeline;
+            if (vkCreateGraphicsPipelines(lveDevice.device(), lveDevice.pipelineCache(), 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create a graphics pipeline");
+            }
+            createMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            return graphicsPipeline;
+    }
+
+    LvePipelineRegistryStats LvePipelineRegistry::stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return counters;
+    }
+
+    void LvePipelineRegistry::printStats(std::ostream& out) {
+        LvePipelineRegistryStats s = stats();
+        out << "pipelines: " << s.uniquePipelines << " created (" << s.derivedPipelines
+            << " derived) for " << s.pipelineRequests << " requests, shader modules: "
+            << s.uniqueShaderModules << " for " << s.shaderModuleRequests << " requests, "
+            << s.createMs << " ms creating ("
+            << (lveDevice.isPipelineCacheWarm() ? "warm" : "cold") << " cache)\n";
+        if (s.warmUpPipelines > 0) {
+            out << "pipeline warm-up: " << s.warmUpReady << " / " << s.warmUpPipelines << " ready";
+            if (s.warmUpReady == s.warmUpPipelines) {
+                out << ", all pipelines ready after " << s.warmUpMs << " ms";
+            }
+            out << ", " << s.warmUpWaits << " requests waited\n";
+        }
+    }
+}
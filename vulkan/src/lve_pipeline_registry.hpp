@@ -0,0 +1,153 @@
+#pragma once
+
+#include "lve_pipeline.hpp"
+
+// std
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace lve {
+
+    // A shader module shared by every pipeline built from the same SPIR-V
+    struct LveShaderModule {
+        VkShaderModule module = VK_NULL_HANDLE;
+        uint64_t id = 0; // stands in for the SPIR-V in pipeline keys
+    };
+
+    // A pipeline shared by every LvePipeline asking for the same shaders and config.
+    // Destroyed with the last reference.
+    struct LveSharedPipeline {
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        std::shared_ptr<const LveShaderModule> vertModule;
+        std::shared_ptr<const LveShaderModule> fragModule;
+        bool derivative = false;
+    };
+
+    struct LvePipelineRegistryStats {
+        uint64_t pipelineRequests = 0;
+        uint64_t uniquePipelines = 0;     // created, the rest were shared
+        uint64_t derivedPipelines = 0;    // created as derivatives of a live sibling
+        uint64_t shaderModuleRequests = 0;
+        uint64_t uniqueShaderModules = 0;
+        double createMs = 0.0;            // inside vkCreateGraphicsPipelines, summed over threads
+
+        uint64_t warmUpPipelines = 0;     // queued by warmUp()
+        uint64_t warmUpReady = 0;
+        uint64_t warmUpWaits = 0;         // requests that waited for a warm-up build instead of compiling
+        double warmUpMs = 0.0;            // warmUp() call to all pipelines ready, 0 while building
+    };
+
+    // Deduplicates shader modules and pipelines. Modules are keyed by their SPIR-V contents,
+    // pipelines by the fixed function state of their PipelineConfigInfo plus both modules, so
+    // two LvePipelines with the same shaders and config share one VkPipeline no matter which
+    // files the SPIR-V came from.
+    //
+    // Pipelines that only differ in fixed function state (same shaders, layout and render pass)
+    // are created as derivatives of the first live one, which lets drivers share work between them.
+    //
+    // Every pipeline asked for is written to manifestPath at shutdown. warmUp() builds the
+    // ones from the previous run on worker threads, so they are ready (or at least on their
+    // way) before the frames that need them; a getPipeline() for one still being built waits
+    // for it rather than compiling it twice.
+    //
+    // Owned by LveDevice, all pipelines are created with its pipeline cache.
+    class LvePipelineRegistry {
+        public:
+            explicit LvePipelineRegistry(LveDevice &device);
+            ~LvePipelineRegistry();
+
+            LvePipelineRegistry(const LvePipelineRegistry&) = delete;
+            LvePipelineRegistry& operator=(const LvePipelineRegistry&) = delete;
+
+            std::shared_ptr<const LveSharedPipeline> getPipeline(
+                const std::string& vertFilepath,
+                const std::string& fragFilepath,
+                const PipelineConfigInfo& configInfo);
+
+            // Layouts and render passes can't be saved, the manifest numbers them in the order
+            // they were first used in instead; pass the same ones in the same order.
+            // Returns right away, threadCount 0 uses all cores but one.
+            void warmUp(
+                const std::vector<VkPipelineLayout>& layouts,
+                const std::vector<VkRenderPass>& renderPasses,
+                unsigned threadCount = 0);
+            bool isWarmUpDone();
+            void waitForWarmUp();
+
+            LvePipelineRegistryStats stats();
+            void printStats(std::ostream& out);
+
+            const std::string manifestPath = "pipeline_manifest.txt";
+
+        private:
+            using PipelineRef = std::shared_ptr<const LveSharedPipeline>;
+            using ModuleRef = std::shared_ptr<const LveShaderModule>;
+
+            struct Request {
+                PipelineConfigInfo configInfo;
+                ModuleRef vertModule;
+                ModuleRef fragModule;
+                std::string familyKey;
+                std::string key;
+            };
+
+            static std::vector<char> readFile(const std::string& filepath);
+            static std::string stateKey(const PipelineConfigInfo& configInfo);
+            static bool readStateKey(const std::string& key, PipelineConfigInfo& configInfo);
+
+            // all of these with the mutex held
+            ModuleRef getShaderModule(const std::string& filepath);
+            // getShaderModule() without counting a request, for warm-up
+            ModuleRef loadShaderModule(const std::string& filepath);
+            Request makeRequest(ModuleRef vertModule, ModuleRef fragModule, const PipelineConfigInfo& configInfo);
+            void record(const std::string& vertFilepath, const std::string& fragFilepath, const PipelineConfigInfo& configInfo);
+            // Expects the promise's future under pending[request.key], unlocks while
+            // vkCreateGraphicsPipelines runs
+            PipelineRef build(
+                std::unique_lock<std::mutex>& lock, const Request& request, std::promise<PipelineRef>& promise);
+
+            VkPipeline createGraphicsPipeline(
+                const PipelineConfigInfo& configInfo,
+                VkShaderModule vertModule,
+                VkShaderModule fragModule,
+                VkPipeline basePipeline,
+                double& createMs);
+            void warmUpWorker();
+            void saveManifest();
+
+            LveDevice& lveDevice;
+            std::mutex mutex;
+            uint64_t nextModuleId = 1;
+
+            // entries expire with the last reference, lookups replace expired ones
+            std::unordered_map<std::string, std::weak_ptr<const LveShaderModule>> shaderModules; // by SPIR-V
+            std::unordered_map<std::string, std::weak_ptr<const LveSharedPipeline>> pipelines;   // by full key
+            std::unordered_map<std::string, std::weak_ptr<const LveSharedPipeline>> families;    // by shaders + layout + pass
+            std::unordered_map<std::string, std::shared_future<PipelineRef>> pending;            // being built
+
+            // manifest of this run, one line per distinct pipeline
+            std::vector<VkPipelineLayout> seenLayouts;
+            std::vector<VkRenderPass> seenRenderPasses;
+            std::vector<std::string> manifest;
+            std::unordered_set<std::string> manifestLines;
+
+            std::vector<Request> warmUpQueue;
+            std::vector<std::promise<PipelineRef>> warmUpPromises;
+            std::atomic<size_t> warmUpNext{0};
+            std::vector<std::thread> warmUpThreads;
+            std::vector<PipelineRef> warmed; // nothing may have asked for them yet, kept for the registry's lifetime
+            std::chrono::steady_clock::time_point warmUpStart;
+
+            LvePipelineRegistryStats counters;
+    };
+} // namespace lve
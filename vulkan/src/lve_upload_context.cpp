@@ -0,0 +1,645 @@
+#include "lve_upload_context.hpp"
+
+#include "lve_device.hpp"
+
+// std headers
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+
+namespace {
+
+// covers the texel size of every format and the 4 byte rule for buffer offsets
+constexpr VkDeviceSize kStagingAlignment = 16;
+
+uint64_t alignUp(uint64_t v, uint64_t alignment) { return (v + alignment - 1) / alignment * alignment; }
+
+}  // namespace
+
+LveUploadContext::LveUploadContext(LveDevice &device, VkDeviceSize ringSize)
+    : device{device}, ringSize{alignUp(ringSize, kStagingAlignment)} {
+  queue = device.transferQueue();
+  dedicated = device.hasDedicatedTransferQueue();
+  transferFamily = device.transferQueueFamily();
+  graphicsFamily = device.findPhysicalQueueFamilies().graphicsFamily;
+
+  device.createBuffer(
+      this->ringSize,
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+      ringBuffer,
+      ringAllocation);
+
+  current.ticket = 1;
+}
+
+LveUploadContext::~LveUploadContext() {
+  waitAll();
+  for (Batch &batch : spare) {
+    vkFreeCommandBuffers(device.device(), device.getTransferCommandPool(), 1, &batch.commandBuffer);
+    vkDestroyFence(device.device(), batch.fence, nullptr);
+    if (dedicated) {
+      vkFreeCommandBuffers(device.device(), device.getCommandPool(), 1, &batch.acquireCommandBuffer);
+      vkDestroySemaphore(device.device(), batch.semaphore, nullptr);
+    }
+    if (batch.graphicsReleaseCommandBuffer != VK_NULL_HANDLE) {
+      vkFreeCommandBuffers(
+          device.device(), device.getCommandPool(), 1, &batch.graphicsReleaseCommandBuffer);
+    }
+    if (batch.graphicsDone != VK_NULL_HANDLE) {
+      vkDestroySemaphore(device.device(), batch.graphicsDone, nullptr);
+    }
+  }
+  device.destroyBuffer(ringBuffer, ringAllocation);
+}
+
+VkCommandBuffer LveUploadContext::commandBuffer() {
+  if (current.recording) {
+    return current.commandBuffer;
+  }
+
+  if (!spare.empty()) {
+    current.commandBuffer = spare.back().commandBuffer;
+    current.fence = spare.back().fence;
+    current.acquireCommandBuffer = spare.back().acquireCommandBuffer;
+    current.graphicsReleaseCommandBuffer = spare.back().graphicsReleaseCommandBuffer;
+    current.graphicsDone = spare.back().graphicsDone;
+    current.semaphore = spare.back().semaphore;
+    spare.pop_back();
+  } else {
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = device.getTransferCommandPool();
+    allocInfo.commandBufferCount = 1;
+    if (vkAllocateCommandBuffers(device.device(), &allocInfo, &current.commandBuffer) !=
+        VK_SUCCESS) {
+      throw std::runtime_error("failed to allocate upload command buffer!");
+    }
+
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if (vkCreateFence(device.device(), &fenceInfo, nullptr, &current.fence) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create upload fence!");
+    }
+
+    if (dedicated) {
+      allocInfo.commandPool = device.getCommandPool();
+      if (vkAllocateCommandBuffers(device.device(), &allocInfo, &current.acquireCommandBuffer) !=
+          VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate upload command buffer!");
+      }
+
+      VkSemaphoreCreateInfo semaphoreInfo = {};
+      semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+      if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &current.semaphore) !=
+          VK_SUCCESS) {
+        throw std::runtime_error("failed to create upload semaphore!");
+      }
+    }
+  }
+
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(current.commandBuffer, &beginInfo);
+  current.recording = true;
+  return current.commandBuffer;
+}
+
+void LveUploadContext::finishImage(VkImage image, uint32_t layerCount, VkImageLayout finalLayout) {
+  if (dedicated) {
+    for (const Release &release : current.releases) {
+      if (release.image == image) return;
+    }
+    Release release;
+    release.image = image;
+    release.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    release.newLayout = finalLayout;
+    release.layerCount = layerCount;
+    current.releases.push_back(release);
+    return;
+  }
+  if (finalLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+    return;
+  }
+
+  // the visibility for whoever reads it comes from the barrier at the end of the batch
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = finalLayout;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.layerCount = layerCount;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = 0;
+  vkCmdPipelineBarrier(
+      current.commandBuffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0,
+      0,
+      nullptr,
+      0,
+      nullptr,
+      1,
+      &barrier);
+}
+
+void LveUploadContext::finishBuffer(VkBuffer buffer) {
+  if (!dedicated) {
+    return;
+  }
+  for (const Release &release : current.releases) {
+    if (release.buffer == buffer) return;
+  }
+  Release release;
+  release.buffer = buffer;
+  current.releases.push_back(release);
+}
+
+void LveUploadContext::reacquireBuffer(VkBuffer buffer) {
+  if (!dedicated || graphicsBuffers.count(buffer) == 0) {
+    return;
+  }
+  for (const VkBufferMemoryBarrier &reacquired : current.reacquires) {
+    if (reacquired.buffer == buffer) return;
+  }
+
+  // acquire half of a graphics to transfer handover, the release is submitted on the
+  // graphics queue ahead of the batch; the copy keeps what lies outside its range
+  VkBufferMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.srcQueueFamilyIndex = graphicsFamily;
+  barrier.dstQueueFamilyIndex = transferFamily;
+  barrier.buffer = buffer;
+  barrier.size = VK_WHOLE_SIZE;
+  vkCmdPipelineBarrier(
+      commandBuffer(),
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0,
+      0,
+      nullptr,
+      1,
+      &barrier,
+      0,
+      nullptr);
+  current.reacquires.push_back(barrier);
+  current.waitForGraphics = true;
+}
+
+void LveUploadContext::reacquireImage(VkImage image) {
+  // the whole image is replaced, so no ownership transfer, only wait for graphics to be done
+  // with it before the transfer queue writes
+  if (dedicated && graphicsImages.count(image) != 0) {
+    current.waitForGraphics = true;
+  }
+}
+
+void LveUploadContext::toTransferDst(VkImage image, uint32_t layerCount) {
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.layerCount = layerCount;
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  vkCmdPipelineBarrier(
+      commandBuffer(),
+      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0,
+      0,
+      nullptr,
+      0,
+      nullptr,
+      1,
+      &barrier);
+  reacquireImage(image);
+}
+
+std::pair<VkBuffer, VkDeviceSize> LveUploadContext::stage(const void *data, VkDeviceSize size) {
+  if (alignUp(size, kStagingAlignment) > ringSize) {
+    // would never fit, give it a buffer of its own that goes away with the batch
+    VkBuffer buffer;
+    LveAllocation *allocation;
+    device.createBuffer(
+        size,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        buffer,
+        allocation);
+    std::memcpy(allocation->mapped, data, size);
+    current.temporaries.emplace_back(buffer, allocation);
+    oversized++;
+    return {buffer, 0};
+  }
+
+  for (;;) {
+    uint64_t position = alignUp(ringHead, kStagingAlignment);
+    if (position % ringSize + size > ringSize) {
+      position = alignUp(position, ringSize);  // no room before the end, start over at 0
+    }
+    if (position + size - ringTail <= ringSize) {
+      ringHead = position + size;
+      VkDeviceSize offset = position % ringSize;
+      std::memcpy(static_cast<char *>(ringAllocation->mapped) + offset, data, size);
+      return {ringBuffer, offset};
+    }
+
+    // full: the current batch has to go out before anything in it can come back
+    ringStalls++;
+    flush();
+    if (!inFlight.empty()) {
+      retire(true);
+    } else {
+      ringHead = ringTail = alignUp(ringHead, ringSize);
+    }
+  }
+}
+
+LveUploadTicket LveUploadContext::uploadBuffer(
+    VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data, VkDeviceSize size) {
+  auto [stagingBuffer, stagingOffset] = stage(data, size);
+  reacquireBuffer(dstBuffer);
+
+  VkBufferCopy copyRegion{};
+  copyRegion.srcOffset = stagingOffset;
+  copyRegion.dstOffset = dstOffset;
+  copyRegion.size = size;
+  vkCmdCopyBuffer(commandBuffer(), stagingBuffer, dstBuffer, 1, &copyRegion);
+  finishBuffer(dstBuffer);
+
+  copies++;
+  current.bytes += size;
+  return current.ticket;
+}
+
+LveUploadTicket LveUploadContext::uploadImage(
+    VkImage image,
+    uint32_t width,
+    uint32_t height,
+    uint32_t layerCount,
+    const void *data,
+    VkDeviceSize size,
+    VkImageLayout finalLayout) {
+  auto [stagingBuffer, stagingOffset] = stage(data, size);
+  toTransferDst(image, layerCount);
+
+  VkBufferImageCopy region{};
+  region.bufferOffset = stagingOffset;
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.layerCount = layerCount;
+  region.imageExtent = {width, height, 1};
+  vkCmdCopyBufferToImage(
+      commandBuffer(), stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+  finishImage(image, layerCount, finalLayout);
+
+  copies++;
+  current.bytes += size;
+  return current.ticket;
+}
+
+LveUploadTicket LveUploadContext::copyBuffer(
+    VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+  reacquireBuffer(dstBuffer);
+  VkBufferCopy copyRegion{};
+  copyRegion.size = size;
+  vkCmdCopyBuffer(commandBuffer(), srcBuffer, dstBuffer, 1, &copyRegion);
+  finishBuffer(dstBuffer);
+
+  copies++;
+  current.bytes += size;
+  return current.ticket;
+}
+
+LveUploadTicket LveUploadContext::copyBufferToImage(
+    VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount) {
+  toTransferDst(image, layerCount);
+
+  VkBufferImageCopy region{};
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.layerCount = layerCount;
+  region.imageExtent = {width, height, 1};
+  vkCmdCopyBufferToImage(
+      commandBuffer(), buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+  finishImage(image, layerCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+  copies++;  // bytes unknown without the format, left out of the throughput
+  return current.ticket;
+}
+
+LveUploadTicket LveUploadContext::flush() {
+  if (!current.recording) {
+    return current.ticket - 1;
+  }
+
+  if (dedicated) {
+    submitWithOwnershipTransfer();
+  } else {
+    // one barrier for the whole batch: transfer writes become visible to anything submitted
+    // to the queue after it
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    vkCmdPipelineBarrier(
+        current.commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        0,
+        1,
+        &barrier,
+        0,
+        nullptr,
+        0,
+        nullptr);
+    vkEndCommandBuffer(current.commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &current.commandBuffer;
+    if (vkQueueSubmit(queue, 1, &submitInfo, current.fence) != VK_SUCCESS) {
+      throw std::runtime_error("failed to submit upload batch!");
+    }
+  }
+
+  LveUploadTicket ticket = current.ticket;
+  current.recording = false;
+  current.ringEnd = ringHead;
+  current.submitted = Clock::now();
+  inFlight.push_back(std::move(current));
+  current = Batch{};
+  current.ticket = ticket + 1;
+  flushes++;
+  return ticket;
+}
+
+void LveUploadContext::submitWithOwnershipTransfer() {
+  // release and acquire need matching barriers, only the access masks and stages differ
+  std::vector<VkBufferMemoryBarrier> bufferBarriers;
+  std::vector<VkImageMemoryBarrier> imageBarriers;
+  for (const Release &release : current.releases) {
+    if (release.buffer != VK_NULL_HANDLE) {
+      VkBufferMemoryBarrier barrier{};
+      barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+      barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.srcQueueFamilyIndex = transferFamily;
+      barrier.dstQueueFamilyIndex = graphicsFamily;
+      barrier.buffer = release.buffer;
+      barrier.size = VK_WHOLE_SIZE;
+      bufferBarriers.push_back(barrier);
+    } else {
+      VkImageMemoryBarrier barrier{};
+      barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+      barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.oldLayout = release.oldLayout;
+      barrier.newLayout = release.newLayout;
+      barrier.srcQueueFamilyIndex = transferFamily;
+      barrier.dstQueueFamilyIndex = graphicsFamily;
+      barrier.image = release.image;
+      barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      barrier.subresourceRange.levelCount = 1;
+      barrier.subresourceRange.layerCount = release.layerCount;
+      imageBarriers.push_back(barrier);
+    }
+  }
+
+  vkCmdPipelineBarrier(
+      current.commandBuffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+      0,
+      0,
+      nullptr,
+      static_cast<uint32_t>(bufferBarriers.size()),
+      bufferBarriers.data(),
+      static_cast<uint32_t>(imageBarriers.size()),
+      imageBarriers.data());
+  vkEndCommandBuffer(current.commandBuffer);
+
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &current.commandBuffer;
+  submitInfo.signalSemaphoreCount = 1;
+  submitInfo.pSignalSemaphores = &current.semaphore;
+  VkPipelineStageFlags graphicsWaitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+  if (current.waitForGraphics) {
+    submitGraphicsRelease();
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &current.graphicsDone;
+    submitInfo.pWaitDstStageMask = &graphicsWaitStage;
+  }
+  if (vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+    throw std::runtime_error("failed to submit upload batch!");
+  }
+
+  // the acquire half on the graphics queue, which also makes the writes visible to
+  // everything submitted there later
+  for (VkBufferMemoryBarrier &barrier : bufferBarriers) {
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+  }
+  for (VkImageMemoryBarrier &barrier : imageBarriers) {
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+  }
+
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(current.acquireCommandBuffer, &beginInfo);
+  vkCmdPipelineBarrier(
+      current.acquireCommandBuffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+      0,
+      0,
+      nullptr,
+      static_cast<uint32_t>(bufferBarriers.size()),
+      bufferBarriers.data(),
+      static_cast<uint32_t>(imageBarriers.size()),
+      imageBarriers.data());
+  vkEndCommandBuffer(current.acquireCommandBuffer);
+
+  VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+  submitInfo.waitSemaphoreCount = 1;
+  submitInfo.pWaitSemaphores = &current.semaphore;
+  submitInfo.pWaitDstStageMask = &waitStage;
+  submitInfo.pCommandBuffers = &current.acquireCommandBuffer;
+  submitInfo.signalSemaphoreCount = 0;
+  submitInfo.pSignalSemaphores = nullptr;
+  if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, current.fence) != VK_SUCCESS) {
+    throw std::runtime_error("failed to submit upload acquire!");
+  }
+
+  for (const Release &release : current.releases) {
+    if (release.buffer != VK_NULL_HANDLE) {
+      graphicsBuffers.insert(release.buffer);
+    } else {
+      graphicsImages.insert(release.image);
+    }
+  }
+}
+
+void LveUploadContext::submitGraphicsRelease() {
+  if (current.graphicsDone == VK_NULL_HANDLE) {
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &current.graphicsDone) !=
+        VK_SUCCESS) {
+      throw std::runtime_error("failed to create upload semaphore!");
+    }
+  }
+
+  // everything submitted to the graphics queue so far is done with what the batch rewrites
+  // once the semaphore signals; images need nothing more, buffers are released as well
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.signalSemaphoreCount = 1;
+  submitInfo.pSignalSemaphores = &current.graphicsDone;
+
+  if (!current.reacquires.empty()) {
+    if (current.graphicsReleaseCommandBuffer == VK_NULL_HANDLE) {
+      VkCommandBufferAllocateInfo allocInfo{};
+      allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+      allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+      allocInfo.commandPool = device.getCommandPool();
+      allocInfo.commandBufferCount = 1;
+      if (vkAllocateCommandBuffers(
+              device.device(), &allocInfo, &current.graphicsReleaseCommandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate upload command buffer!");
+      }
+    }
+
+    std::vector<VkBufferMemoryBarrier> releases = current.reacquires;
+    for (VkBufferMemoryBarrier &barrier : releases) {
+      barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+      barrier.dstAccessMask = 0;
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(current.graphicsReleaseCommandBuffer, &beginInfo);
+    vkCmdPipelineBarrier(
+        current.graphicsReleaseCommandBuffer,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0,
+        0,
+        nullptr,
+        static_cast<uint32_t>(releases.size()),
+        releases.data(),
+        0,
+        nullptr);
+    vkEndCommandBuffer(current.graphicsReleaseCommandBuffer);
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &current.graphicsReleaseCommandBuffer;
+  }
+
+  if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+    throw std::runtime_error("failed to submit upload release!");
+  }
+}
+
+void LveUploadContext::retire(bool block) {
+  while (!inFlight.empty()) {
+    Batch &batch = inFlight.front();
+    if (vkGetFenceStatus(device.device(), batch.fence) != VK_SUCCESS) {
+      if (!block) {
+        return;
+      }
+      vkWaitForFences(device.device(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+    }
+    block = false;  // only ever wait for one batch, the rest only if they are done anyway
+    retireFront();
+  }
+}
+
+void LveUploadContext::retireFront() {
+  Batch &batch = inFlight.front();
+  gpuSeconds += std::chrono::duration<double>(Clock::now() - batch.submitted).count();
+  bytes += batch.bytes;
+  ringTail = batch.ringEnd;
+  completed = batch.ticket;
+
+  for (auto &[buffer, allocation] : batch.temporaries) {
+    device.destroyBuffer(buffer, allocation);
+  }
+  vkResetFences(device.device(), 1, &batch.fence);
+  vkResetCommandBuffer(batch.commandBuffer, 0);
+  if (dedicated) {
+    vkResetCommandBuffer(batch.acquireCommandBuffer, 0);
+  }
+  if (batch.graphicsReleaseCommandBuffer != VK_NULL_HANDLE) {
+    vkResetCommandBuffer(batch.graphicsReleaseCommandBuffer, 0);
+  }
+
+  Batch reusable;
+  reusable.commandBuffer = batch.commandBuffer;
+  reusable.fence = batch.fence;
+  reusable.acquireCommandBuffer = batch.acquireCommandBuffer;
+  reusable.semaphore = batch.semaphore;
+  reusable.graphicsReleaseCommandBuffer = batch.graphicsReleaseCommandBuffer;
+  reusable.graphicsDone = batch.graphicsDone;
+  spare.push_back(std::move(reusable));
+  inFlight.pop_front();
+}
+
+bool LveUploadContext::isComplete(LveUploadTicket ticket) {
+  retire(false);
+  return ticket <= completed;
+}
+
+void LveUploadContext::wait(LveUploadTicket ticket) {
+  if (ticket >= current.ticket) {
+    flush();
+  }
+  while (completed < ticket && !inFlight.empty()) {
+    retire(true);
+  }
+}
+
+LveUploadStats LveUploadContext::takeStats() {
+  retire(false);
+
+  LveUploadStats stats;
+  stats.flushes = flushes;
+  stats.copies = copies;
+  stats.bytes = bytes;
+  stats.uploadMBps = gpuSeconds > 0.0 ? bytes / (1024.0 * 1024.0) / gpuSeconds : 0.0;
+  stats.batchesInFlight = static_cast<uint32_t>(inFlight.size());
+  stats.ringStalls = ringStalls;
+  stats.oversized = oversized;
+
+  flushes = copies = bytes = ringStalls = oversized = 0;
+  gpuSeconds = 0.0;
+  return stats;
+}
+
+void LveUploadContext::printStats(std::ostream &out) {
+  LveUploadStats stats = takeStats();
+  out << "uploads: " << stats.copies << " copies in " << stats.flushes << " flushes, "
+      << stats.bytes / (1024.0 * 1024.0) << " MiB at " << stats.uploadMBps << " MB/s, "
+      << stats.batchesInFlight << " batches in flight, " << stats.ringStalls << " ring stalls, "
+      << stats.oversized << " oversized\n";
+}
+
+}  // namespace lve
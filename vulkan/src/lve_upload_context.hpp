@@ -0,0 +1,172 @@
+#pragma once
+
+#include "lve_allocator.hpp"
+
+// std lib headers
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace lve {
+
+class LveDevice;
+
+// Identifies the batch an upload went into. Tickets grow with every flush, so a ticket is
+// done once every batch up to and including it is done; 0 is always done.
+using LveUploadTicket = uint64_t;
+
+struct LveUploadStats {
+  uint64_t flushes = 0;
+  uint64_t copies = 0;
+  uint64_t bytes = 0;        // retired since the last takeStats()
+  double uploadMBps = 0.0;   // bytes over the time batches spent between submit and retiring
+  uint32_t batchesInFlight = 0;
+  uint64_t ringStalls = 0;   // times an upload had to wait for the ring to drain
+  uint64_t oversized = 0;    // uploads larger than the ring, staged in a buffer of their own
+};
+
+// Copies data to device local buffers and images through a persistently mapped staging
+// ring. Copies are recorded into one command buffer per batch and submitted together on
+// flush(); each batch carries a fence, and its part of the ring is reused once the fence
+// has signaled. Nothing here idles a queue.
+//
+// The source data is copied into the ring right away, so it can be freed when the upload
+// call returns. The destination must not be used by the GPU before the ticket's batch has
+// been submitted (later submissions on the same queue are ordered after it by a barrier),
+// or read back before the ticket is done.
+//
+// With a dedicated transfer queue the batches run there, concurrently with rendering. Each
+// batch then ends by releasing its buffers and images to the graphics family and signals a
+// semaphore; a small graphics submission waits on it, acquires them and signals the batch
+// fence, so a finished ticket means the resources are owned by the graphics queue. Writing
+// again into something handed over before goes the other way first: a graphics submission
+// releases it (or, for images, whose contents are replaced, just finishes with it) and
+// signals a semaphore the batch waits on. Without a dedicated transfer queue (single family
+// devices such as lavapipe) the batches go straight to the graphics queue.
+//
+// Not thread safe.
+class LveUploadContext {
+ public:
+  LveUploadContext(LveDevice &device, VkDeviceSize ringSize = VkDeviceSize{32} << 20);
+  ~LveUploadContext();
+
+  LveUploadContext(const LveUploadContext &) = delete;
+  LveUploadContext &operator=(const LveUploadContext &) = delete;
+
+  LveUploadTicket uploadBuffer(
+      VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data, VkDeviceSize size);
+  // Whole image, tightly packed; moves it from undefined to finalLayout
+  LveUploadTicket uploadImage(
+      VkImage image,
+      uint32_t width,
+      uint32_t height,
+      uint32_t layerCount,
+      const void *data,
+      VkDeviceSize size,
+      VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+  // Device to device copies recorded into the current batch, for callers with their own
+  // staging buffer. srcBuffer has to stay alive until the ticket is done.
+  LveUploadTicket copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+  // Replaces the whole image like uploadImage(), left in TRANSFER_DST_OPTIMAL. The batch does
+  // the layout transition, callers don't.
+  LveUploadTicket copyBufferToImage(
+      VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
+
+  // Submits the current batch, if anything was recorded. Returns the last submitted ticket.
+  LveUploadTicket flush();
+  bool isComplete(LveUploadTicket ticket);
+  // Flushes first when the ticket is still being recorded
+  void wait(LveUploadTicket ticket);
+  void waitAll() { wait(flush()); }
+
+  LveUploadStats takeStats();
+  void printStats(std::ostream &out);
+
+  // The handle is being destroyed and may come back for a new resource
+  void forgetBuffer(VkBuffer buffer) { graphicsBuffers.erase(buffer); }
+  void forgetImage(VkImage image) { graphicsImages.erase(image); }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // A destination handed from the transfer to the graphics family at the end of a batch
+  struct Release {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkImage image = VK_NULL_HANDLE;
+    VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    uint32_t layerCount = 0;
+  };
+
+  struct Batch {
+    LveUploadTicket ticket = 0;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+    // dedicated transfer queue only
+    VkCommandBuffer acquireCommandBuffer = VK_NULL_HANDLE;
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    std::vector<Release> releases;
+    // dedicated transfer queue, rewriting what the graphics queue owns
+    VkCommandBuffer graphicsReleaseCommandBuffer = VK_NULL_HANDLE;
+    VkSemaphore graphicsDone = VK_NULL_HANDLE;
+    std::vector<VkBufferMemoryBarrier> reacquires;
+    bool waitForGraphics = false;
+
+    bool recording = false;
+    uint64_t ringEnd = 0;  // ring position after this batch's last staging range
+    VkDeviceSize bytes = 0;
+    std::vector<std::pair<VkBuffer, LveAllocation *>> temporaries;  // oversized staging
+    Clock::time_point submitted;
+  };
+
+  VkCommandBuffer commandBuffer();  // begins the current batch if needed
+  // Before a copy into something the graphics queue may own or still use
+  void reacquireBuffer(VkBuffer buffer);
+  void reacquireImage(VkImage image);
+  void toTransferDst(VkImage image, uint32_t layerCount);
+  // Layout change for an image, or ownership release for anything, once its copy is recorded
+  void finishImage(VkImage image, uint32_t layerCount, VkImageLayout finalLayout);
+  void finishBuffer(VkBuffer buffer);
+  void submitWithOwnershipTransfer();
+  void submitGraphicsRelease();
+  // Copies data into staging memory, returns the buffer and offset to copy from
+  std::pair<VkBuffer, VkDeviceSize> stage(const void *data, VkDeviceSize size);
+  void retire(bool block);
+  void retireFront();
+
+  LveDevice &device;
+  VkQueue queue;
+  bool dedicated;
+  uint32_t transferFamily;
+  uint32_t graphicsFamily;
+
+  VkBuffer ringBuffer;
+  LveAllocation *ringAllocation;
+  VkDeviceSize ringSize;
+  // positions only ever grow, position % ringSize is the offset into the ring
+  uint64_t ringHead = 0;
+  uint64_t ringTail = 0;
+
+  // handed to the graphics family by an earlier batch
+  std::unordered_set<VkBuffer> graphicsBuffers;
+  std::unordered_set<VkImage> graphicsImages;
+
+  Batch current;
+  std::deque<Batch> inFlight;  // oldest first
+  std::vector<Batch> spare;    // retired, command buffer and fence ready for reuse
+  LveUploadTicket completed = 0;
+
+  uint64_t flushes = 0;
+  uint64_t copies = 0;
+  uint64_t bytes = 0;
+  double gpuSeconds = 0.0;
+  uint64_t ringStalls = 0;
+  uint64_t oversized = 0;
+};
+
+}  // namespace lve
@@ -16,9 +16,59 @@ namespace lve {
     void LveWindow::initWindow() {
         glfwInit();
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
         window = glfwCreateWindow(width, height, windowName.c_str(), nullptr, nullptr);
+        // the framebuffer can be larger than the window on high DPI screens
+        glfwGetFramebufferSize(window, &width, &height);
+
+        glfwSetWindowUserPointer(window, this);
+        glfwSetWindowRefreshCallback(window, refreshCallback);
+        glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+        glfwSetWindowFocusCallback(window, focusCallback);
+        glfwSetWindowIconifyCallback(window, iconifyCallback);
+    }
+
+    void LveWindow::waitEvents(double timeout) {
+        if (timeout <= 0.0) {
+            glfwPollEvents();
+        } else {
+            glfwWaitEventsTimeout(timeout);
+        }
+    }
+
+    bool LveWindow::takeInvalidated() {
+        bool was = invalidated;
+        invalidated = false;
+        return was;
+    }
+
+    void LveWindow::refreshCallback(GLFWwindow *window) {
+        auto lveWindow = reinterpret_cast<LveWindow *>(glfwGetWindowUserPointer(window));
+        lveWindow->invalidated = true;
+    }
+
+    void LveWindow::framebufferResizeCallback(GLFWwindow *window, int width, int height) {
+        auto lveWindow = reinterpret_cast<LveWindow *>(glfwGetWindowUserPointer(window));
+        lveWindow->invalidated = true;
+        lveWindow->framebufferResized = true;
+        lveWindow->width = width;
+        lveWindow->height = height;
+        // a 0x0 framebuffer is how some platforms report minimizing
+        lveWindow->minimized = width == 0 || height == 0;
+    }
+
+    void LveWindow::focusCallback(GLFWwindow *window, int focused) {
+        auto lveWindow = reinterpret_cast<LveWindow *>(glfwGetWindowUserPointer(window));
+        lveWindow->focused = focused == GLFW_TRUE;
+    }
+
+    void LveWindow::iconifyCallback(GLFWwindow *window, int iconified) {
+        auto lveWindow = reinterpret_cast<LveWindow *>(glfwGetWindowUserPointer(window));
+        lveWindow->minimized = iconified == GLFW_TRUE;
+        if (!iconified) {
+            lveWindow->invalidated = true;
+        }
     }
 
     void LveWindow::createWindowSurface(VkInstance instance, VkSurfaceKHR *surface) {
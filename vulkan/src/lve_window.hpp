@@ -19,14 +19,38 @@ namespace lve {
 
             bool shouldClose() { return glfwWindowShouldClose(window); }
 
+            // Sleeps until an event arrives or timeout seconds pass (0 = just poll)
+            void waitEvents(double timeout);
+
+            // Set by refresh / resize / restore callbacks, reading it clears it
+            bool takeInvalidated();
+            bool isFocused() const { return focused; }
+            bool isMinimized() const { return minimized; }
+
+            // Framebuffer size, in pixels; follows resizes
+            VkExtent2D getExtent() const { return {static_cast<uint32_t>(width), static_cast<uint32_t>(height)}; }
+            // Set on resize until reset, for whoever owns the swapchain to recreate it
+            bool wasWindowResized() const { return framebufferResized; }
+            void resetWindowResizedFlag() { framebufferResized = false; }
+
             void createWindowSurface(VkInstance instance, VkSurfaceKHR *surface);
         private:
             void initWindow();
 
-            const int width;
-            const int height;
+            static void refreshCallback(GLFWwindow *window);
+            static void framebufferResizeCallback(GLFWwindow *window, int width, int height);
+            static void focusCallback(GLFWwindow *window, int focused);
+            static void iconifyCallback(GLFWwindow *window, int iconified);
+
+            int width;
+            int height;
+            bool framebufferResized = false;
 
             std::string windowName;
             GLFWwindow *window;
+
+            bool invalidated = true;
+            bool focused = true;
+            bool minimized = false;
     };
 } // namespace lve
\ No newline at end of file
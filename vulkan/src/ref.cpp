@@ -5,10 +5,18 @@
 #include <vector>
 #include <optional>
 #include <set>
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <stdexcept>
 #include <cstdlib>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 
 const uint32_t WIDTH = 800;
 const uint32_t HEIGHT = 600;
@@ -114,15 +122,23 @@ VkRenderPass renderPass;
 VkPipelineLayout pipelineLayout;
 VkPipeline graphicsPipeline;
 
+bool framebufferResized = false;
+
 // The rest (framebuffers, commands, sync) come in PART 2
 
 // =====================================================
 // Window
 // =====================================================
+void framebufferResizeCallback(GLFWwindow*, int, int) {
+    framebufferResized = true;
+}
+
 void initWindow() {
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
     window = glfwCreateWindow(WIDTH, HEIGHT, "Vulkan Triangle (Single File)", nullptr, nullptr);
+    glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
 }
 
 // =====================================================
@@ -350,10 +366,43 @@ VkSurfaceFormatKHR chooseFormat(const std::vector<VkSurfaceFormatKHR>& formats)
     return formats[0];
 }
 
+// --present, each policy falls back down its list; FIFO is the one mode every device has
+enum class PresentPolicy {
+    LowLatency,   // mailbox, immediate: newest frame wins, mailbox without tearing
+    PowerSaving,  // fifo: vsync, the CPU and GPU sleep when ahead
+    FifoRelaxed,  // fifo relaxed: vsync, but a late frame tears instead of waiting a whole refresh
+};
+
+PresentPolicy presentPolicy = PresentPolicy::LowLatency;
+uint32_t swapImageCount = 0; // --images N, 0 = one more than the minimum
+VkPresentModeKHR presentMode;
+
+const char* presentModeName(VkPresentModeKHR mode) {
+    switch (mode) {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: return "immediate";
+        case VK_PRESENT_MODE_MAILBOX_KHR: return "mailbox";
+        case VK_PRESENT_MODE_FIFO_KHR: return "fifo";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "fifo relaxed";
+        default: return "unknown";
+    }
+}
+
 VkPresentModeKHR choosePresentMode(const std::vector<VkPresentModeKHR>& modes) {
-    for (auto& m : modes) {
-        if (m == VK_PRESENT_MODE_MAILBOX_KHR)
-            return m;
+    std::vector<VkPresentModeKHR> preferred;
+    switch (presentPolicy) {
+        case PresentPolicy::LowLatency:
+            preferred = { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR };
+            break;
+        case PresentPolicy::PowerSaving:
+            break;
+        case PresentPolicy::FifoRelaxed:
+            preferred = { VK_PRESENT_MODE_FIFO_RELAXED_KHR };
+            break;
+    }
+
+    for (auto want : preferred) {
+        if (std::find(modes.begin(), modes.end(), want) != modes.end())
+            return want;
     }
     return VK_PRESENT_MODE_FIFO_KHR;
 }
@@ -361,19 +410,38 @@ VkPresentModeKHR choosePresentMode(const std::vector<VkPresentModeKHR>& modes) {
 VkExtent2D chooseExtent(const VkSurfaceCapabilitiesKHR& caps) {
     if (caps.currentExtent.width != UINT32_MAX)
         return caps.currentExtent;
-    return { WIDTH, HEIGHT };
+
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+
+    VkExtent2D extent = { (uint32_t)width, (uint32_t)height };
+    extent.width = std::clamp(extent.width, caps.minImageExtent.width, caps.maxImageExtent.width);
+    extent.height = std::clamp(extent.height, caps.minImageExtent.height, caps.maxImageExtent.height);
+    return extent;
+}
+
+// More images let the CPU run further ahead of the display, fewer keep latency down
+uint32_t chooseImageCount(const VkSurfaceCapabilitiesKHR& caps) {
+    uint32_t imageCount = swapImageCount ? swapImageCount : caps.minImageCount + 1;
+    imageCount = std::max(imageCount, caps.minImageCount);
+    if (caps.maxImageCount > 0 && imageCount > caps.maxImageCount)
+        imageCount = caps.maxImageCount;
+    return imageCount;
 }
 
-void createSwapchain() {
+// oldSwapchain lets the driver hand resources over and keep presenting the old images
+// until the new ones arrive; it is retired by this call but still has to be destroyed.
+void createSwapchain(VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE) {
     SwapSupport s = querySwapSupport(physicalDevice);
 
     auto format = chooseFormat(s.formats);
     auto mode = choosePresentMode(s.modes);
     auto extent = chooseExtent(s.caps);
+    uint32_t imageCount = chooseImageCount(s.caps);
 
-    uint32_t imageCount = s.caps.minImageCount + 1;
-    if (s.caps.maxImageCount > 0 && imageCount > s.caps.maxImageCount)
-        imageCount = s.caps.maxImageCount;
+    // The render pass was made for the first format, surfaces don't change formats on resize
+    if (oldSwapchain != VK_NULL_HANDLE && format.format != swapFormat)
+        throw std::runtime_error("Surface format changed");
 
     QueueFamilies q = findQueueFamilies(physicalDevice);
     uint32_t families[] = { q.graphics.value(), q.present.value() };
@@ -400,6 +468,7 @@ void createSwapchain() {
     ci.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     ci.presentMode = mode;
     ci.clipped = VK_TRUE;
+    ci.oldSwapchain = oldSwapchain;
 
     if (vkCreateSwapchainKHR(device, &ci, nullptr, &swapchain) != VK_SUCCESS)
         throw std::runtime_error("Failed to create swapchain");
@@ -411,6 +480,10 @@ void createSwapchain() {
 
     swapFormat = format.format;
     swapExtent = extent;
+    presentMode = mode;
+
+    std::cout << "Swapchain: " << extent.width << "x" << extent.height << ", "
+              << count << " images, " << presentModeName(mode) << "\n";
 }
 
 void createImageViews() {
@@ -508,20 +581,18 @@ void createGraphicsPipeline() {
     assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
     assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 
-    VkViewport viewport{};
-    viewport.width = (float)swapExtent.width;
-    viewport.height = (float)swapExtent.height;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor{};
-    scissor.extent = swapExtent;
-
+    // Set while recording, so the pipeline survives swapchain recreation
     VkPipelineViewportStateCreateInfo vp{};
     vp.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     vp.viewportCount = 1;
-    vp.pViewports = &viewport;
     vp.scissorCount = 1;
-    vp.pScissors = &scissor;
+
+    VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+    VkPipelineDynamicStateCreateInfo dynamic{};
+    dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic.dynamicStateCount = 2;
+    dynamic.pDynamicStates = dynamicStates;
 
     // ---- FIXED RASTERIZATION ----
     VkPipelineRasterizationStateCreateInfo raster{};
@@ -564,6 +635,7 @@ void createGraphicsPipeline() {
     ci.pRasterizationState = &raster;
     ci.pMultisampleState = &ms;
     ci.pColorBlendState = &blendState;
+    ci.pDynamicState = &dynamic;
     ci.layout = pipelineLayout;
     ci.renderPass = renderPass;
 
@@ -600,95 +672,451 @@ void createFramebuffers() {
 }
 
 // =====================================================
-// COMMAND POOL + COMMAND BUFFERS
+// FRAME RING
 // =====================================================
-VkCommandPool commandPool;
-std::vector<VkCommandBuffer> commandBuffers;
+// Everything the CPU writes while building a frame lives in a Frame, and there are
+// framesInFlight of them, so the next frame can be recorded while the GPU is still on
+// the previous one. A frame's fence guards its command buffers.
+//
+// Swapchain images are tracked on their own: acquire hands them out in whatever order
+// the presentation engine likes, so an image can come back while the frame that last
+// rendered to it is still running. imagesInFlight remembers that frame's fence.
+uint32_t framesInFlight = 2; // --frames N, 1 makes the CPU wait for the GPU every frame
+uint32_t recordThreads = 0;  // --threads N, 0 uses every core
+
+using Clock = std::chrono::steady_clock;
+
+struct Frame {
+    VkCommandPool commandPool;     // transient, reset as a whole each time the frame comes round
+    VkCommandBuffer commandBuffer;
+    // one pool and one secondary command buffer per recording thread, pools can't be shared
+    std::vector<VkCommandPool> threadPools;
+    std::vector<VkCommandBuffer> secondaries;
+    VkSemaphore imageAvailable;
+    VkFence inFlight;
+    Clock::time_point inputTime;  // when the input this frame shows was read
+    bool submitted = false;
+};
 
-void createCommandPool() {
+std::vector<Frame> frames;
+uint32_t currentFrame = 0;
+uint64_t submittedFrames = 0;
+
+// per swapchain image
+std::vector<VkFence> imagesInFlight;      // fence of the frame last rendering to it, or null
+std::vector<VkSemaphore> renderFinished;  // waited on by present, which has no fence to tell when it's free
+
+void createFrames() {
     QueueFamilies q = findQueueFamilies(physicalDevice);
+    frames.resize(framesInFlight);
+
+    for (auto& frame : frames) {
+        VkCommandPoolCreateInfo pi{};
+        pi.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pi.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        pi.queueFamilyIndex = q.graphics.value();
+
+        if (vkCreateCommandPool(device, &pi, nullptr, &frame.commandPool) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create command pool");
 
-    VkCommandPoolCreateInfo ci{};
-    ci.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    ci.queueFamilyIndex = q.graphics.value();
+        VkCommandBufferAllocateInfo ai{};
+        ai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        ai.commandPool = frame.commandPool;
+        ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        ai.commandBufferCount = 1;
 
-    if (vkCreateCommandPool(device, &ci, nullptr, &commandPool) != VK_SUCCESS)
-        throw std::runtime_error("Failed to create command pool");
+        if (vkAllocateCommandBuffers(device, &ai, &frame.commandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("Failed to allocate command buffers");
+
+        frame.threadPools.resize(recordThreads);
+        frame.secondaries.resize(recordThreads);
+
+        for (uint32_t t = 0; t < recordThreads; t++) {
+            if (vkCreateCommandPool(device, &pi, nullptr, &frame.threadPools[t]) != VK_SUCCESS)
+                throw std::runtime_error("Failed to create command pool");
+
+            ai.commandPool = frame.threadPools[t];
+            ai.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+
+            if (vkAllocateCommandBuffers(device, &ai, &frame.secondaries[t]) != VK_SUCCESS)
+                throw std::runtime_error("Failed to allocate command buffers");
+        }
+
+        VkSemaphoreCreateInfo si{};
+        si.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        if (vkCreateSemaphore(device, &si, nullptr, &frame.imageAvailable) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create semaphores");
+
+        VkFenceCreateInfo fi{};
+        fi.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fi.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+        if (vkCreateFence(device, &fi, nullptr, &frame.inFlight) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create fence");
+    }
+}
+
+void createImageSyncObjects() {
+    imagesInFlight.assign(swapImages.size(), VK_NULL_HANDLE);
+    renderFinished.resize(swapImages.size());
+
+    VkSemaphoreCreateInfo si{};
+    si.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (auto& semaphore : renderFinished) {
+        if (vkCreateSemaphore(device, &si, nullptr, &semaphore) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create semaphores");
+    }
 }
 
-void createCommandBuffers() {
-    commandBuffers.resize(framebuffers.size());
+// =====================================================
+// DRAW LIST
+// =====================================================
+// What gets drawn this frame, rebuilt or edited freely between frames since command
+// buffers are recorded from it every frame.
+struct DrawCommand {
+    uint32_t vertexCount;
+    uint32_t instanceCount;
+    uint32_t firstVertex;
+    uint32_t firstInstance;
+};
 
-    VkCommandBufferAllocateInfo ai{};
-    ai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    ai.commandPool = commandPool;
-    ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    ai.commandBufferCount = commandBuffers.size();
+std::vector<DrawCommand> drawList;
+uint32_t drawCount = 50000; // --draws N
 
-    if (vkAllocateCommandBuffers(device, &ai, commandBuffers.data()) != VK_SUCCESS)
-        throw std::runtime_error("Failed to allocate command buffers");
+void buildDrawList() {
+    drawList.assign(drawCount, DrawCommand{ 3, 1, 0, 0 });
+}
 
-    for (size_t i = 0; i < commandBuffers.size(); i++) {
-        VkCommandBufferBeginInfo bi{};
-        bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+// =====================================================
+// RECORDING THREADS
+// =====================================================
+// recordThreads - 1 workers parked on a condition variable; the main thread takes part
+// as thread 0, so --threads 1 records everything on the main thread with no handoff.
+struct RecordWorkers {
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::function<void(uint32_t)> job; // only written while every worker is idle
+    uint64_t generation = 0;
+    uint32_t remaining = 0;
+    std::exception_ptr error;
+    bool quit = false;
+} workers;
+
+void workerLoop(uint32_t thread) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(workers.mutex);
+            workers.wake.wait(lock, [&] { return workers.quit || workers.generation != seen; });
+            if (workers.quit) return;
+            seen = workers.generation;
+        }
 
-        vkBeginCommandBuffer(commandBuffers[i], &bi);
+        std::exception_ptr error;
+        try {
+            workers.job(thread);
+        } catch (...) {
+            error = std::current_exception();
+        }
 
-        VkRenderPassBeginInfo rp{};
-        rp.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        rp.renderPass = renderPass;
-        rp.framebuffer = framebuffers[i];
-        rp.renderArea.offset = { 0, 0 };
-        rp.renderArea.extent = swapExtent;
+        std::lock_guard<std::mutex> lock(workers.mutex);
+        if (error && !workers.error) workers.error = error;
+        if (--workers.remaining == 0) workers.done.notify_one();
+    }
+}
 
-        VkClearValue clear = { 0.1f, 0.1f, 0.2f, 1.0f };
-        rp.clearValueCount = 1;
-        rp.pClearValues = &clear;
+void startWorkers() {
+    if (recordThreads == 0)
+        recordThreads = std::max(1u, std::thread::hardware_concurrency());
 
-        vkCmdBeginRenderPass(commandBuffers[i], &rp, VK_SUBPASS_CONTENTS_INLINE);
-        vkCmdBindPipeline(commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-        vkCmdDraw(commandBuffers[i], 3, 1, 0, 0);
-        vkCmdEndRenderPass(commandBuffers[i]);
+    for (uint32_t t = 1; t < recordThreads; t++)
+        workers.threads.emplace_back(workerLoop, t);
+}
 
-        if (vkEndCommandBuffer(commandBuffers[i]) != VK_SUCCESS)
-            throw std::runtime_error("Failed to record command buffer");
+void stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(workers.mutex);
+        workers.quit = true;
     }
+    workers.wake.notify_all();
+    for (auto& t : workers.threads)
+        t.join();
+    workers.threads.clear();
+}
+
+// Runs job(t) for every recording thread t and returns once all of them are done
+void runOnWorkers(std::function<void(uint32_t)> job) {
+    {
+        std::lock_guard<std::mutex> lock(workers.mutex);
+        workers.job = std::move(job);
+        workers.remaining = (uint32_t)workers.threads.size();
+        workers.generation++;
+    }
+    workers.wake.notify_all();
+
+    std::exception_ptr error;
+    try {
+        workers.job(0);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lock(workers.mutex);
+    workers.done.wait(lock, [] { return workers.remaining == 0; });
+    if (!error) error = workers.error;
+    workers.error = nullptr;
+    if (error) std::rethrow_exception(error);
 }
 
 // =====================================================
-// SYNC OBJECTS
+// SWAPCHAIN RECREATION
 // =====================================================
-VkSemaphore imageAvailable;
-VkSemaphore renderFinished;
-VkFence inFlight;
+// Resizes and out of date swapchains don't idle the device. The new swapchain is created
+// from the old one, and the old one with its views, framebuffers and semaphores is
+// destroyed once every frame submitted before the switch has come round again, which
+// means its fence has been waited on.
+struct RetiredSwapchain {
+    VkSwapchainKHR swapchain;
+    std::vector<VkImageView> imageViews;
+    std::vector<VkFramebuffer> framebuffers;
+    std::vector<VkSemaphore> renderFinished;
+    uint64_t destroyAt; // submittedFrames value at which it's unused
+};
 
-void createSyncObjects() {
-    VkSemaphoreCreateInfo si{};
-    si.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+std::vector<RetiredSwapchain> retiredSwapchains;
+
+void destroyRetired(RetiredSwapchain& r) {
+    for (auto fb : r.framebuffers)
+        vkDestroyFramebuffer(device, fb, nullptr);
+    for (auto iv : r.imageViews)
+        vkDestroyImageView(device, iv, nullptr);
+    for (auto semaphore : r.renderFinished)
+        vkDestroySemaphore(device, semaphore, nullptr);
+    vkDestroySwapchainKHR(device, r.swapchain, nullptr);
+}
+
+// Called after the current frame's fence wait
+void destroyRetiredSwapchains() {
+    auto done = std::remove_if(retiredSwapchains.begin(), retiredSwapchains.end(),
+        [](RetiredSwapchain& r) {
+            if (submittedFrames < r.destroyAt) return false;
+            destroyRetired(r);
+            return true;
+        });
+    retiredSwapchains.erase(done, retiredSwapchains.end());
+}
+
+void recreateSwapchain() {
+    // A minimized window has a 0x0 framebuffer, there's nothing to create until it's back
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+    while ((width == 0 || height == 0) && !glfwWindowShouldClose(window)) {
+        glfwWaitEvents();
+        glfwGetFramebufferSize(window, &width, &height);
+    }
+    if (width == 0 || height == 0) return;
+
+    // The frame that waits on frame submittedFrames - 1 is framesInFlight frames later
+    RetiredSwapchain old{ swapchain, swapImageViews, framebuffers, renderFinished,
+                          submittedFrames + framesInFlight - 1 };
+    retiredSwapchains.push_back(old);
+
+    createSwapchain(old.swapchain);
+    createImageViews();
+    createFramebuffers();
+    createImageSyncObjects();
+}
+
+// =====================================================
+// FRAME TIMINGS
+// =====================================================
+// CPU time spent blocked on fences and acquire, averaged over a couple of seconds.
+// Run with --frames 1 for the old single fence behaviour to compare against.
+//
+// Latency runs from the input read before a frame to the moment its fence is seen
+// signaled, when the frame slot comes round again. That's when the image is ready to be
+// shown, so it includes any wait for the presentation engine to release the image (the
+// queueing FIFO adds) but not the wait for the next scanout. When the wait doesn't
+// block, the fence signaled earlier and the sample is off by up to one CPU frame.
+struct FrameTimings {
+    uint64_t frames = 0;
+    double waitMs = 0.0;
+    double recordMs = 0.0;
+    double frameMs = 0.0;
+    uint64_t latencySamples = 0;
+    double latencyMs = 0.0;
+    double maxLatencyMs = 0.0;
+    Clock::time_point start = Clock::now();
+
+    uint64_t totalFrames = 0;
+    double totalWaitMs = 0.0;
+} timings;
+
+double msSince(Clock::time_point t) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+}
+
+void reportTimings(bool final) {
+    if (!final && msSince(timings.start) < 2000.0) return;
+
+    if (timings.frames > 0) {
+        std::cout << "[frames] " << framesInFlight << " in flight: CPU wait "
+                  << timings.waitMs / timings.frames << " ms/frame, recording "
+                  << drawList.size() << " draws on " << recordThreads << " threads "
+                  << timings.recordMs / timings.frames << " ms/frame, frame "
+                  << timings.frameMs / timings.frames << " ms\n";
+    }
+    if (timings.latencySamples > 0) {
+        std::cout << "[frames] " << presentModeName(presentMode) << ", " << swapImages.size()
+                  << " images: input to ready " << timings.latencyMs / timings.latencySamples
+                  << " ms avg, " << timings.maxLatencyMs << " ms max\n";
+    }
+    if (final && timings.totalFrames > 0) {
+        std::cout << "[frames] overall CPU wait "
+                  << timings.totalWaitMs / timings.totalFrames << " ms/frame over "
+                  << timings.totalFrames << " frames\n";
+    }
+
+    timings.frames = 0;
+    timings.waitMs = 0.0;
+    timings.recordMs = 0.0;
+    timings.frameMs = 0.0;
+    timings.latencySamples = 0;
+    timings.latencyMs = 0.0;
+    timings.maxLatencyMs = 0.0;
+    timings.start = Clock::now();
+}
+
+// =====================================================
+// COMMAND RECORDING
+// =====================================================
+// Records drawList[begin, end) into one thread's secondary command buffer, which
+// continues the primary's render pass
+void recordSecondary(Frame& frame, uint32_t thread, uint32_t imageIndex, size_t begin, size_t end) {
+    vkResetCommandPool(device, frame.threadPools[thread], 0);
+    VkCommandBuffer cmd = frame.secondaries[thread];
+
+    VkCommandBufferInheritanceInfo inherit{};
+    inherit.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inherit.renderPass = renderPass;
+    inherit.subpass = 0;
+    inherit.framebuffer = framebuffers[imageIndex];
+
+    VkCommandBufferBeginInfo bi{};
+    bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    bi.pInheritanceInfo = &inherit;
+
+    vkBeginCommandBuffer(cmd, &bi);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+
+    // Dynamic state isn't inherited from the primary
+    VkViewport viewport{};
+    viewport.width = (float)swapExtent.width;
+    viewport.height = (float)swapExtent.height;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.extent = swapExtent;
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+    for (size_t i = begin; i < end; i++) {
+        const DrawCommand& d = drawList[i];
+        vkCmdDraw(cmd, d.vertexCount, d.instanceCount, d.firstVertex, d.firstInstance);
+    }
 
-    if (vkCreateSemaphore(device, &si, nullptr, &imageAvailable) != VK_SUCCESS ||
-        vkCreateSemaphore(device, &si, nullptr, &renderFinished) != VK_SUCCESS)
-        throw std::runtime_error("Failed to create semaphores");
+    if (vkEndCommandBuffer(cmd) != VK_SUCCESS)
+        throw std::runtime_error("Failed to record command buffer");
+}
+
+void recordCommandBuffer(Frame& frame, uint32_t imageIndex) {
+    // Contiguous slices, the last threads may get nothing when there are few draws
+    size_t perThread = (drawList.size() + recordThreads - 1) / recordThreads;
+    runOnWorkers([&](uint32_t thread) {
+        size_t begin = std::min(drawList.size(), thread * perThread);
+        size_t end = std::min(drawList.size(), begin + perThread);
+        recordSecondary(frame, thread, imageIndex, begin, end);
+    });
+
+    VkCommandBuffer cmd = frame.commandBuffer;
+
+    VkCommandBufferBeginInfo bi{};
+    bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-    VkFenceCreateInfo fi{};
-    fi.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fi.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    vkBeginCommandBuffer(cmd, &bi);
 
-    if (vkCreateFence(device, &fi, nullptr, &inFlight) != VK_SUCCESS)
-        throw std::runtime_error("Failed to create fence");
+    VkRenderPassBeginInfo rp{};
+    rp.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rp.renderPass = renderPass;
+    rp.framebuffer = framebuffers[imageIndex];
+    rp.renderArea.offset = { 0, 0 };
+    rp.renderArea.extent = swapExtent;
+
+    VkClearValue clear = { 0.1f, 0.1f, 0.2f, 1.0f };
+    rp.clearValueCount = 1;
+    rp.pClearValues = &clear;
+
+    vkCmdBeginRenderPass(cmd, &rp, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(cmd, (uint32_t)frame.secondaries.size(), frame.secondaries.data());
+    vkCmdEndRenderPass(cmd);
+
+    if (vkEndCommandBuffer(cmd) != VK_SUCCESS)
+        throw std::runtime_error("Failed to record command buffer");
 }
 
 // =====================================================
 // DRAW FRAME
 // =====================================================
-void drawFrame() {
-    vkWaitForFences(device, 1, &inFlight, VK_TRUE, UINT64_MAX);
-    vkResetFences(device, 1, &inFlight);
+// inputTime is when the input this frame reflects was polled
+void drawFrame(Clock::time_point inputTime) {
+    Frame& frame = frames[currentFrame];
+    auto frameStart = Clock::now();
+
+    // Only waits when the GPU is framesInFlight frames behind
+    auto waitStart = Clock::now();
+    vkWaitForFences(device, 1, &frame.inFlight, VK_TRUE, UINT64_MAX);
+    if (frame.submitted) {
+        double latency = msSince(frame.inputTime);
+        timings.latencySamples++;
+        timings.latencyMs += latency;
+        timings.maxLatencyMs = std::max(timings.maxLatencyMs, latency);
+        frame.submitted = false;
+    }
+    destroyRetiredSwapchains();
 
     uint32_t imageIndex;
-    vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imageAvailable, VK_NULL_HANDLE, &imageIndex);
+    VkResult acquired = vkAcquireNextImageKHR(
+        device, swapchain, UINT64_MAX, frame.imageAvailable, VK_NULL_HANDLE, &imageIndex);
 
-    VkSemaphore waitSemaphores[] = { imageAvailable };
+    // Nothing was signaled, the frame's fence is still signaled too, so just try again
+    if (acquired == VK_ERROR_OUT_OF_DATE_KHR) {
+        recreateSwapchain();
+        return;
+    }
+    if (acquired != VK_SUCCESS && acquired != VK_SUBOPTIMAL_KHR)
+        throw std::runtime_error("Failed to acquire swapchain image");
+
+    // An image can come back before the frame that last used it is done with it
+    if (imagesInFlight[imageIndex] != VK_NULL_HANDLE && imagesInFlight[imageIndex] != frame.inFlight)
+        vkWaitForFences(device, 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+    imagesInFlight[imageIndex] = frame.inFlight;
+    double waitMs = msSince(waitStart);
+
+    // Reset only once there's something to submit, so the fence is never left unsignaled
+    vkResetFences(device, 1, &frame.inFlight);
+
+    auto recordStart = Clock::now();
+    vkResetCommandPool(device, frame.commandPool, 0);
+    recordCommandBuffer(frame, imageIndex);
+    timings.recordMs += msSince(recordStart);
+
+    VkSemaphore waitSemaphores[] = { frame.imageAvailable };
     VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 
     VkSubmitInfo si{};
@@ -697,14 +1125,17 @@ void drawFrame() {
     si.pWaitSemaphores = waitSemaphores;
     si.pWaitDstStageMask = waitStages;
     si.commandBufferCount = 1;
-    si.pCommandBuffers = &commandBuffers[imageIndex];
+    si.pCommandBuffers = &frame.commandBuffer;
 
-    VkSemaphore signalSemaphores[] = { renderFinished };
+    VkSemaphore signalSemaphores[] = { renderFinished[imageIndex] };
     si.signalSemaphoreCount = 1;
     si.pSignalSemaphores = signalSemaphores;
 
-    if (vkQueueSubmit(graphicsQueue, 1, &si, inFlight) != VK_SUCCESS)
+    if (vkQueueSubmit(graphicsQueue, 1, &si, frame.inFlight) != VK_SUCCESS)
         throw std::runtime_error("Failed to submit draw command buffer");
+    submittedFrames++;
+    frame.submitted = true;
+    frame.inputTime = inputTime;
 
     VkPresentInfoKHR pi{};
     pi.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -714,16 +1145,47 @@ void drawFrame() {
     pi.pSwapchains = &swapchain;
     pi.pImageIndices = &imageIndex;
 
-    vkQueuePresentKHR(presentQueue, &pi);
+    VkResult presented = vkQueuePresentKHR(presentQueue, &pi);
+
+    currentFrame = (currentFrame + 1) % framesInFlight;
+
+    // Suboptimal still presents, but the next frame should go to a matching swapchain
+    if (presented == VK_ERROR_OUT_OF_DATE_KHR || presented == VK_SUBOPTIMAL_KHR ||
+        acquired == VK_SUBOPTIMAL_KHR || framebufferResized) {
+        framebufferResized = false;
+        recreateSwapchain();
+    } else if (presented != VK_SUCCESS) {
+        throw std::runtime_error("Failed to present swapchain image");
+    }
+
+    timings.frames++;
+    timings.totalFrames++;
+    timings.waitMs += waitMs;
+    timings.totalWaitMs += waitMs;
+    timings.frameMs += msSince(frameStart);
+    reportTimings(false);
 }
 
 // =====================================================
 // CLEANUP
 // =====================================================
 void cleanup() {
-    vkDestroySemaphore(device, renderFinished, nullptr);
-    vkDestroySemaphore(device, imageAvailable, nullptr);
-    vkDestroyFence(device, inFlight, nullptr);
+    stopWorkers();
+
+    for (auto& frame : frames) {
+        vkDestroySemaphore(device, frame.imageAvailable, nullptr);
+        vkDestroyFence(device, frame.inFlight, nullptr);
+        vkDestroyCommandPool(device, frame.commandPool, nullptr);
+        for (auto pool : frame.threadPools)
+            vkDestroyCommandPool(device, pool, nullptr);
+    }
+
+    for (auto& r : retiredSwapchains)
+        destroyRetired(r);
+    retiredSwapchains.clear();
+
+    for (auto semaphore : renderFinished)
+        vkDestroySemaphore(device, semaphore, nullptr);
 
     for (auto fb : framebuffers)
         vkDestroyFramebuffer(device, fb, nullptr);
@@ -737,8 +1199,6 @@ void cleanup() {
 
     vkDestroySwapchainKHR(device, swapchain, nullptr);
 
-    vkDestroyCommandPool(device, commandPool, nullptr);
-
     vkDestroyDevice(device, nullptr);
 
     if (enableValidationLayers)
@@ -754,8 +1214,31 @@ void cleanup() {
 // =====================================================
 // MAIN
 // =====================================================
-int main() {
+int main(int argc, char** argv) {
     try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--frames" && i + 1 < argc) {
+                framesInFlight = (uint32_t)std::max(1, std::atoi(argv[++i]));
+            } else if (arg == "--threads" && i + 1 < argc) {
+                recordThreads = (uint32_t)std::max(0, std::atoi(argv[++i]));
+            } else if (arg == "--draws" && i + 1 < argc) {
+                drawCount = (uint32_t)std::max(0, std::atoi(argv[++i]));
+            } else if (arg == "--images" && i + 1 < argc) {
+                swapImageCount = (uint32_t)std::max(0, std::atoi(argv[++i]));
+            } else if (arg == "--present" && i + 1 < argc && !strcmp(argv[i + 1], "low-latency")) {
+                presentPolicy = PresentPolicy::LowLatency; i++;
+            } else if (arg == "--present" && i + 1 < argc && !strcmp(argv[i + 1], "power-saving")) {
+                presentPolicy = PresentPolicy::PowerSaving; i++;
+            } else if (arg == "--present" && i + 1 < argc && !strcmp(argv[i + 1], "fifo-relaxed")) {
+                presentPolicy = PresentPolicy::FifoRelaxed; i++;
+            } else {
+                std::cerr << "usage: " << argv[0] << " [--frames N] [--threads N] [--draws N] [--images N]"
+                          << " [--present low-latency|power-saving|fifo-relaxed]\n";
+                return EXIT_FAILURE;
+            }
+        }
+
         initWindow();
         createInstance();
         setupDebugMessenger();
@@ -767,19 +1250,22 @@ int main() {
         createRenderPass();
         createGraphicsPipeline();
         createFramebuffers();
-        createCommandPool();
-        createCommandBuffers();
-        createSyncObjects();
+        startWorkers();
+        buildDrawList();
+        createFrames();
+        createImageSyncObjects();
 
         while (!glfwWindowShouldClose(window)) {
             glfwPollEvents();
-            drawFrame();
+            drawFrame(Clock::now());
         }
 
         vkDeviceWaitIdle(device);
+        reportTimings(true);
         cleanup();
 
     } catch (const std::exception& e) {
+        stopWorkers(); // joinable threads would terminate the process on exit
         std::cerr << "FATAL ERROR: " << e.what() << "\n";
         return EXIT_FAILURE;
     }